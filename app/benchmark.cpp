@@ -13,6 +13,11 @@
 #include <cstdlib>
 #include <random>
 #include <fstream>
+#include <tuple>
+#include <map>
+#include <array>
+#include <memory>
+#include <type_traits>
 #include <pthread.h>
 
 #include <tlx/cmdline_parser.hpp>
@@ -31,7 +36,17 @@
 #include "edgeHierarchyQueryOnly.h"
 #include "edgeHierarchyQueryOnlyNoTimestamp.h"
 #include "edgeHierarchyConstruction.h"
+#include "dominatedEdgeRemoval.h"
+#include "partitionedEdgeHierarchyConstruction.h"
+#include "mappedEdgeStore.h"
 #include "dimacsGraphReader.h"
+#include "nodeOrdering.h"
+#include "stallCandidates.h"
+#include "landmarks.h"
+#include "hubLabels.h"
+#include "transitNodes.h"
+#include "stallingCalibration.h"
+#include "stronglyConnectedComponents.h"
 #include "edgeHierarchyWriter.h"
 #include "edgeHierarchyReader.h"
 #include "edgeRanking/shortcutCountingRoundsEdgeRanker.h"
@@ -46,12 +61,45 @@ void pin_to_core(size_t core)
     pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
 }
 
+void unpin(const cpu_set_t &cpuset)
+{
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+// Query time and cache misses of the last EH benchmark run, used to compare
+// node orders
+struct EHMeasurement {
+    long long averageQueryTime;
+    common::papi_result cacheMisses;
+    size_t adjacencyBytes = 0;
+};
+
+EHMeasurement lastEHMeasurement;
+
+// Number of edges the EH query looks ahead when prefetching query state, see
+// EdgeHierarchyQueryOnly::setRelaxBatchSize
+unsigned ehRelaxBatchSize = 0;
+
+// Stall candidates of the query graph being benchmarked, if any
+const StallCandidates *ehStallCandidates = nullptr;
+
+// If set, the query graph being benchmarked has calibrated stalling budgets
+bool ehUseStallingBudgets = false;
+
+// Landmarks of the query graph being benchmarked, if EH queries use them
+const Landmarks *ehLandmarks = nullptr;
+
+// If positive, EH queries return distances of at most 1 + epsilon times the
+// shortest one, see EdgeHierarchyQueryOnly::setApproximationEpsilon
+double ehApproximationEpsilon = 0;
+
 bool fileExists (const std::string& name) {
     ifstream f(name.c_str());
     return f.good();
 }
 
 RoutingKit::ContractionHierarchy getCHFromGraph(EdgeHierarchyGraph &g) {
+    checkRoutingKitLimits(g.getNumberOfNodes(), "The contraction hierarchy", true);
     std::vector<unsigned> tails, heads, weights;
 
     g.forAllNodes([&] (NODE_T tail) {
@@ -70,13 +118,27 @@ RoutingKit::ContractionHierarchy getCHFromGraph(EdgeHierarchyGraph &g) {
 }
 
 template<class EdgeRanker>
-void buildAndWriteEdgeHierarchy(EdgeHierarchyGraph &g, std::string edgeHierarchyFilename) {
-    EdgeHierarchyQuery query(g);
+void buildAndWriteEdgeHierarchy(EdgeHierarchyGraph &g, std::string edgeHierarchyFilename, unsigned numPartitions, unsigned numWorkers, bool removeDominated, bool undirected) {
+    auto start = chrono::steady_clock::now();
+    if(undirected) {
+        EdgeHierarchyQuery query(g);
 
-    EdgeHierarchyConstruction<EdgeRanker> construction(g, query);
+        EdgeHierarchyConstruction<EdgeRanker, true> construction(g, query, true);
 
-    auto start = chrono::steady_clock::now();
-    construction.run();
+        construction.run();
+    }
+    else if(numPartitions > 1) {
+        auto partition = getBFSPartition(g, numPartitions);
+        PartitionedEdgeHierarchyConstruction<EdgeRanker> construction(g, partition, numPartitions, numWorkers, edgeHierarchyFilename);
+        construction.run();
+    }
+    else {
+        EdgeHierarchyQuery query(g);
+
+        EdgeHierarchyConstruction<EdgeRanker> construction(g, query);
+
+        construction.run();
+    }
 	auto end = chrono::steady_clock::now();
 
 	cout << "EH Construction took "
@@ -85,6 +147,16 @@ void buildAndWriteEdgeHierarchy(EdgeHierarchyGraph &g, std::string edgeHierarchy
 
     cout << "Distance in Query graph was equal to removed path " << numEquals << " times" <<endl;
 
+    if(removeDominated) {
+        start = chrono::steady_clock::now();
+        EDGECOUNT_T numRemoved = removeDominatedEdges(g);
+        end = chrono::steady_clock::now();
+
+        cout << "Removing " << numRemoved << " dominated edges took "
+             << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+             << " ms" << endl;
+    }
+
     cout << "Writing Edge Hierarchy to " << edgeHierarchyFilename <<endl;
 
     start = chrono::steady_clock::now();
@@ -109,6 +181,8 @@ struct DijkstraRankRunningtime {
     int timeCH;
     int verticesSettledCH;
     int edgesRelaxedCH;
+    EDGEWEIGHT_T distanceEH;
+    EDGEWEIGHT_T errorBoundEH;
 };
 
 
@@ -173,9 +247,14 @@ std::vector<DijkstraRankRunningtime> GenerateRandomQueries(unsigned numQueries,
     return result;
 }
 
-template<bool partialStalling, bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, template<bool, bool, bool, bool> class QueryType>
-int benchmark(bool dijkstraRank, bool test, EdgeHierarchyGraphQueryOnly &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
-    QueryType<EHForwardStalling, EHBackwardStalling, partialStalling, minimalSearchSpace> newQuery = QueryType<EHForwardStalling, EHBackwardStalling, partialStalling, minimalSearchSpace>(ehGraph);
+template<bool partialStalling, bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, template<bool, bool, bool, bool, class> class QueryType, class Graph>
+int benchmark(bool dijkstraRank, bool test, Graph &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
+    QueryType<EHForwardStalling, EHBackwardStalling, partialStalling, minimalSearchSpace, Graph> newQuery = QueryType<EHForwardStalling, EHBackwardStalling, partialStalling, minimalSearchSpace, Graph>(ehGraph);
+    newQuery.setRelaxBatchSize(ehRelaxBatchSize);
+    newQuery.setStallCandidates(ehStallCandidates);
+    newQuery.setUseStallingBudgets(ehUseStallingBudgets);
+    newQuery.setLandmarks(ehLandmarks);
+    newQuery.setApproximationEpsilon(ehApproximationEpsilon);
     // newQuery.avgSearchSpace = 626;
     // EdgeHierarchyQueryOnly<EHForwardStalling, EHBackwardStalling, minimalSearchSpace> newQuery = EdgeHierarchyQueryOnly<EHForwardStalling, EHBackwardStalling, minimalSearchSpace>(ehGraph);
 
@@ -204,7 +283,12 @@ int benchmark(bool dijkstraRank, bool test, EdgeHierarchyGraphQueryOnly &ehGraph
                 generatedQuery.distance = chDistance;
             }
 
-            if(generatedQuery.distance != distance) {
+            bool correct = distance == generatedQuery.distance;
+            if(ehApproximationEpsilon > 0) {
+                correct = distance >= generatedQuery.distance && distance <= generatedQuery.distance * (1 + ehApproximationEpsilon)
+                    && newQuery.getDistanceLowerBound() <= generatedQuery.distance;
+            }
+            if(!correct) {
                 cout << "EH: Wrong distance for " << u << " and " << v << ": " << distance << " (should be " << generatedQuery.distance << ")" << endl;
                 numMistakes++;
             } else {
@@ -239,12 +323,13 @@ int benchmark(bool dijkstraRank, bool test, EdgeHierarchyGraphQueryOnly &ehGraph
         }
         auto queryStart = chrono::high_resolution_clock::now();
         EDGEWEIGHT_T distance = newQuery.getDistance(u, v, stallingPercent);
-        (void) distance;
         auto queryEnd = chrono::high_resolution_clock::now();
         if(dijkstraRank) {
             generatedQuery.timeEH = chrono::duration_cast<chrono::nanoseconds>(queryEnd - queryStart).count();
             generatedQuery.verticesSettledEH = newQuery.numVerticesSettled;
             generatedQuery.edgesRelaxedEH = newQuery.numEdgesRelaxed + newQuery.numEdgesLookedAtForStalling;
+            generatedQuery.distanceEH = distance;
+            generatedQuery.errorBoundEH = distance == EDGEWEIGHT_INFINITY ? 0 : distance - newQuery.getDistanceLowerBound();
         }
 
         if constexpr(minimalSearchSpace){
@@ -273,6 +358,7 @@ int benchmark(bool dijkstraRank, bool test, EdgeHierarchyGraphQueryOnly &ehGraph
     cache_counter_eh.stop();
 	auto end = chrono::steady_clock::now();
     std::cout << cache_counter_eh.result() << std::endl;
+    lastEHMeasurement = {chrono::duration_cast<chrono::microseconds>(end - start).count() / (long long) queries.size(), cache_counter_eh.result()};
 
     if(!dijkstraRank) {
         cout << "Average query time (EH): "
@@ -376,9 +462,10 @@ int benchmark(bool dijkstraRank, bool test, EdgeHierarchyGraphQueryOnly &ehGraph
     return numMistakes;
 }
 
-template<bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, template<bool, bool, bool, bool> class QueryType>
-int benchmark(bool dijkstraRank, bool test, EdgeHierarchyGraphQueryOnly &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
-    if(stallingPercent == -1)
+template<bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, template<bool, bool, bool, bool, class> class QueryType, class Graph>
+int benchmark(bool dijkstraRank, bool test, Graph &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
+    // Stalling budgets only apply to partial stalling
+    if(stallingPercent == -1 && !ehUseStallingBudgets)
         {
             return benchmark<false, EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, QueryType>(dijkstraRank, test, ehGraph, chQuery, queries, stallingPercent);
         }
@@ -387,51 +474,203 @@ int benchmark(bool dijkstraRank, bool test, EdgeHierarchyGraphQueryOnly &ehGraph
     }
 }
 
-template<bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace>
-int benchmark(bool dijkstraRank, bool test, bool noTimestamp, EdgeHierarchyGraphQueryOnly &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
+template<bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, class Graph>
+int benchmark(bool dijkstraRank, bool test, bool noTimestamp, bool packedQueryState, Graph &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
     if(noTimestamp)
         {
             return -1;
             // return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, EdgeHierarchyQueryOnlyNoTimestamp>(dijkstraRank, test, ehGraph, chQuery, queries, stallingPercent);
         }
+    else if(packedQueryState)
+        return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, EdgeHierarchyQueryOnlyPackedState>(dijkstraRank, test, ehGraph, chQuery, queries, stallingPercent);
     else
-        return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, EdgeHierarchyQueryOnly>(dijkstraRank, test, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, EdgeHierarchyQueryOnlySplitState>(dijkstraRank, test, ehGraph, chQuery, queries, stallingPercent);
 }
 
-template<bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand>
-int benchmark(bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, EdgeHierarchyGraphQueryOnly &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
+template<bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, class Graph>
+int benchmark(bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, bool packedQueryState, Graph &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
     if(minimalSearchSpace)
-        return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, true>(dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, true>(dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
     else
-        return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, false>(dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<EHForwardStalling, EHBackwardStalling, CHStallOnDemand, false>(dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
 }
 
-template<bool EHForwardStalling, bool EHBackwardStalling>
-int benchmark(bool CHStallOnDemand, bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, EdgeHierarchyGraphQueryOnly &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
+template<bool EHForwardStalling, bool EHBackwardStalling, class Graph>
+int benchmark(bool CHStallOnDemand, bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, bool packedQueryState, Graph &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
     if(CHStallOnDemand)
-        return benchmark<EHForwardStalling, EHBackwardStalling, true>(minimalSearchSpace, dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<EHForwardStalling, EHBackwardStalling, true>(minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
     else
-        return benchmark<EHForwardStalling, EHBackwardStalling, false>(minimalSearchSpace, dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<EHForwardStalling, EHBackwardStalling, false>(minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
 }
 
-template<bool EHForwardStalling>
-int benchmark(bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, EdgeHierarchyGraphQueryOnly &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
+template<bool EHForwardStalling, class Graph>
+int benchmark(bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, bool packedQueryState, Graph &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
     if(EHBackwardStalling)
-        return benchmark<EHForwardStalling, true>(CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<EHForwardStalling, true>(CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
     else
-        return benchmark<EHForwardStalling, false>(CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<EHForwardStalling, false>(CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
 }
 
-int benchmark(bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, EdgeHierarchyGraphQueryOnly &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
+template<class Graph>
+int benchmark(bool EHForwardStalling, bool EHBackwardStalling, bool CHStallOnDemand, bool minimalSearchSpace, bool dijkstraRank, bool test, bool noTimestamp, bool packedQueryState, Graph &ehGraph, RoutingKit::ContractionHierarchyQuery &chQuery, std::vector<DijkstraRankRunningtime> &queries, int stallingPercent) {
     if(EHForwardStalling)
-        return benchmark<true>(EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<true>(EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
     else
-        return benchmark<false>(EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, ehGraph, chQuery, queries, stallingPercent);
+        return benchmark<false>(EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, ehGraph, chQuery, queries, stallingPercent);
+}
+
+void benchmarkHubLabels(bool dijkstraRank, bool test, HubLabels &labels, std::vector<DijkstraRankRunningtime> &queries) {
+    if(test) {
+        int numMistakes = 0;
+        for(auto &generatedQuery: queries) {
+            EDGEWEIGHT_T distance = labels.getDistance(generatedQuery.source, generatedQuery.target);
+            if(generatedQuery.distance != INVALID_QUERY_DATA && generatedQuery.distance != distance) {
+                cout << "HL: Wrong distance for " << generatedQuery.source << " and " << generatedQuery.target << ": " << distance << " (should be " << generatedQuery.distance << ")" << endl;
+                numMistakes++;
+            }
+        }
+        cout << numMistakes << " out of " << queries.size() << " WRONG!!! (HL)" << endl;
+    }
+
+    std::vector<long long> queryTimes;
+    auto start = chrono::steady_clock::now();
+    for(auto &generatedQuery: queries) {
+        auto queryStart = chrono::high_resolution_clock::now();
+        EDGEWEIGHT_T distance = labels.getDistance(generatedQuery.source, generatedQuery.target);
+        (void) distance;
+        auto queryEnd = chrono::high_resolution_clock::now();
+        if(dijkstraRank) {
+            queryTimes.push_back(chrono::duration_cast<chrono::nanoseconds>(queryEnd - queryStart).count());
+        }
+    }
+    auto end = chrono::steady_clock::now();
+    cout << "Average query time (HL): "
+         << chrono::duration_cast<chrono::nanoseconds>(end - start).count() / queries.size()
+         << " ns" << endl;
+    if(dijkstraRank) {
+        std::cout << "Format: rank time" << std::endl;
+        for(size_t i = 0; i < queries.size(); ++i) {
+            std::cout << "result HL: " << queries[i].rank << " " << queryTimes[i] << std::endl;
+        }
+    }
 }
 
+// Local queries fall back to an EH query with full backward stalling
+template<class Graph>
+void benchmarkTransitNodes(bool dijkstraRank, bool test, TransitNodes &transitNodes, Graph &ehGraph, std::vector<DijkstraRankRunningtime> &queries) {
+    EdgeHierarchyQueryOnly<false, true, false, false, Graph, PackedQueryState> localQuery(ehGraph);
+    if(test) {
+        int numMistakes = 0;
+        for(auto &generatedQuery: queries) {
+            EDGEWEIGHT_T distance = transitNodes.getDistance(localQuery, generatedQuery.source, generatedQuery.target, -1);
+            if(generatedQuery.distance != INVALID_QUERY_DATA && generatedQuery.distance != distance) {
+                cout << "TNR: Wrong distance for " << generatedQuery.source << " and " << generatedQuery.target << ": " << distance << " (should be " << generatedQuery.distance << ")" << endl;
+                numMistakes++;
+            }
+        }
+        cout << numMistakes << " out of " << queries.size() << " WRONG!!! (TNR)" << endl;
+    }
+
+    std::vector<long long> queryTimes;
+    size_t numLocal = 0;
+    long long localTime = 0;
+    auto start = chrono::steady_clock::now();
+    for(auto &generatedQuery: queries) {
+        auto queryStart = chrono::high_resolution_clock::now();
+        const bool local = transitNodes.isLocal(generatedQuery.source, generatedQuery.target);
+        EDGEWEIGHT_T distance = local ? localQuery.getDistance(generatedQuery.source, generatedQuery.target, -1) : transitNodes.getGlobalDistance(generatedQuery.source, generatedQuery.target);
+        (void) distance;
+        auto queryEnd = chrono::high_resolution_clock::now();
+        const long long queryTime = chrono::duration_cast<chrono::nanoseconds>(queryEnd - queryStart).count();
+        if(local) {
+            ++numLocal;
+            localTime += queryTime;
+        }
+        if(dijkstraRank) {
+            queryTimes.push_back(queryTime);
+        }
+    }
+    auto end = chrono::steady_clock::now();
+    const long long totalTime = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+    cout << "Average query time (TNR): " << totalTime / queries.size() << " ns, "
+         << numLocal << " out of " << queries.size() << " queries are local" << endl;
+    if(numLocal > 0) {
+        cout << "Average local query time (TNR): " << localTime / numLocal << " ns" << endl;
+    }
+    if(numLocal < queries.size()) {
+        cout << "Average global query time (TNR): " << std::max(totalTime - localTime, 0ll) / (long long) (queries.size() - numLocal) << " ns" << endl;
+    }
+    if(dijkstraRank) {
+        std::cout << "Format: rank time local" << std::endl;
+        for(size_t i = 0; i < queries.size(); ++i) {
+            std::cout << "result TNR: " << queries[i].rank << " " << queryTimes[i] << " " << transitNodes.isLocal(queries[i].source, queries[i].target) << std::endl;
+        }
+    }
+}
+
+// Average EH query time and vertices settled per Dijkstra rank, without and
+// with landmarks
+void printLandmarkReport(const std::vector<DijkstraRankRunningtime> &withoutLandmarks, const std::vector<DijkstraRankRunningtime> &withLandmarks) {
+    std::map<unsigned, std::array<long long, 5>> perRank;
+    for(size_t i = 0; i < withoutLandmarks.size(); ++i) {
+        auto &sums = perRank[withoutLandmarks[i].rank];
+        sums[0] += withoutLandmarks[i].timeEH;
+        sums[1] += withLandmarks[i].timeEH;
+        sums[2] += withoutLandmarks[i].verticesSettledEH;
+        sums[3] += withLandmarks[i].verticesSettledEH;
+        ++sums[4];
+    }
+    std::cout << "Landmark report (rank, time without, time with [ns], vertices settled without, with):" << std::endl;
+    for(auto &[rank, sums] : perRank) {
+        std::cout << rank << " " << sums[0] / sums[4] << " " << sums[1] / sums[4]
+                  << " " << sums[2] / sums[4] << " " << sums[3] / sums[4] << std::endl;
+    }
+}
+
+// Speedup of approximate over exact EH queries and the relative error of
+// the approximate distances per Dijkstra rank
+void printApproximationReport(const std::vector<DijkstraRankRunningtime> &exactQueries, const std::vector<DijkstraRankRunningtime> &approximateQueries) {
+    struct rankSums {
+        long long timeExact = 0;
+        long long timeApproximate = 0;
+        double error = 0;
+        double maxError = 0;
+        double errorBound = 0;
+        size_t numExact = 0;
+        size_t numQueries = 0;
+        size_t numFinite = 0;
+    };
+    std::map<unsigned, rankSums> perRank;
+    for(size_t i = 0; i < exactQueries.size(); ++i) {
+        rankSums &sums = perRank[exactQueries[i].rank];
+        sums.timeExact += exactQueries[i].timeEH;
+        sums.timeApproximate += approximateQueries[i].timeEH;
+        ++sums.numQueries;
+        const EDGEWEIGHT_T exactDistance = exactQueries[i].distanceEH;
+        const EDGEWEIGHT_T approximateDistance = approximateQueries[i].distanceEH;
+        if(approximateDistance == exactDistance) {
+            ++sums.numExact;
+        }
+        if(exactDistance != 0 && exactDistance != EDGEWEIGHT_INFINITY) {
+            const double error = (double(approximateDistance) - exactDistance) / exactDistance;
+            sums.error += error;
+            sums.maxError = std::max(sums.maxError, error);
+            sums.errorBound += double(approximateQueries[i].errorBoundEH) / exactDistance;
+            ++sums.numFinite;
+        }
+    }
+    std::cout << "Approximation report (rank, time exact, time approximate [ns], speedup, exact answers [%], average error, maximum error, average guaranteed error [%]):" << std::endl;
+    for(auto &[rank, sums] : perRank) {
+        const size_t numFinite = std::max<size_t>(sums.numFinite, 1);
+        std::cout << rank << " " << sums.timeExact / (long long) sums.numQueries << " " << sums.timeApproximate / (long long) sums.numQueries
+                  << " " << double(sums.timeExact) / std::max(sums.timeApproximate, 1ll)
+                  << " " << 100.0 * sums.numExact / sums.numQueries
+                  << " " << 100 * sums.error / numFinite << " " << 100 * sums.maxError
+                  << " " << 100 * sums.errorBound / numFinite << std::endl;
+    }
+}
 
 int main(int argc, char* argv[]) {
-    pin_to_core(0);
     tlx::CmdlineParser cp;
 
     cp.set_description("Benchmark program for EdgeHierarchies");
@@ -457,6 +696,14 @@ int main(int argc, char* argv[]) {
     cp.add_unsigned('u', "uTurnCost", uTurnCost,
                     "Cost to be added for u-turns (only has effect when turn costs are activated).");
 
+    unsigned junctionTurnCost = 0;
+    cp.add_unsigned("junctionTurnCost", junctionTurnCost,
+                    "Cost to be added for turns at vertices with more than one way to continue (only has effect when turn costs are activated).");
+
+    unsigned numThreads = getDefaultNumThreads();
+    cp.add_unsigned("threads", numThreads,
+                    "Number of threads used for preprocessing steps that run in parallel. Queries always run on a single core.");
+
     bool useCHForEHConstruction = false;
     cp.add_bool ("useCH", useCHForEHConstruction,
                  "If this flag is set, CH queries will be used during EH construction");
@@ -469,6 +716,114 @@ int main(int argc, char* argv[]) {
     cp.add_bool ("CHOrder", CHOrder,
                  "If this flag is set, EHs will use the node ordering from CHs");
 
+    std::string nodeOrderName;
+    cp.add_string ("nodeOrder", nodeOrderName,
+                   "Node order of the query graph: ch, dfspre, dfspost, bfs, hilbert, maxrank, partition or hotcore. Overrides DFSPreOrder and CHOrder");
+
+    bool compareNodeOrders = false;
+    cp.add_bool ("compareNodeOrders", compareNodeOrders,
+                 "If this flag is set, the benchmark is run with every available node order and a report of query times and cache misses is printed");
+
+    std::string coordinateFilename;
+    cp.add_string ("coordinates", coordinateFilename,
+                   "DIMACS coordinate file of the input graph, needed for the hilbert node order");
+
+    unsigned numOrderPartitions = 64;
+    cp.add_unsigned ("orderPartitions", numOrderPartitions,
+                     "Number of blocks used by the partition node order");
+
+    double hotCorePercent = 1;
+    cp.add_double ("hotCorePercent", hotCorePercent,
+                   "Percentage of vertices with the highest ranked incident edges that the hotcore node order packs into one block");
+
+    std::string edgeLayoutName;
+    cp.add_string ("edgeLayout", edgeLayoutName,
+                   "Memory layout of the query graph edges: grouped, split, ranksplit, interleaved, compressed, packed or packed16 (both imply quantizeRanks)");
+
+    bool compareEdgeLayouts = false;
+    cp.add_bool ("compareEdgeLayouts", compareEdgeLayouts,
+                 "If this flag is set, the benchmark is run with every edge layout and a report of query times and cache misses is printed");
+
+    bool quantizeRanks = false;
+    cp.add_bool ("quantizeRanks", quantizeRanks,
+                 "If this flag is set, the edge ranks are replaced by the fewest levels that keep every comparison a query makes");
+
+    bool nodeSummaries = false;
+    cp.add_bool ("nodeSummaries", nodeSummaries,
+                 "If this flag is set, the query graph keeps a record of the edge offsets, degrees and maximum edge ranks of each vertex, so that vertices without relevant edges are skipped without fetching their edges");
+
+    bool packedQueryState = false;
+    cp.add_bool ("packedQueryState", packedQueryState,
+                 "If this flag is set, EH queries keep the timestamp, distance, rank and heap position of each vertex in one 16 byte record instead of separate arrays");
+
+    bool compareQueryStates = false;
+    cp.add_bool ("compareQueryStates", compareQueryStates,
+                 "If this flag is set, the benchmark is run with both the split and the packed query state and a report of query times and cache misses is printed");
+
+    unsigned relaxBatchSize = 0;
+    cp.add_unsigned ("relaxBatchSize", relaxBatchSize,
+                     "If set, EH queries collect the edges of a settled vertex first and prefetch the query state this many edges ahead of the one being relaxed. Set 0 to relax edges as they are found. (default: 0)");
+
+    bool compareRelaxBatchSize = false;
+    cp.add_bool ("compareRelaxBatchSize", compareRelaxBatchSize,
+                 "If this flag is set, the benchmark is run both without batching and with the given relaxBatchSize and a report of query times and cache misses is printed");
+
+    bool componentLabels = false;
+    cp.add_bool ("componentLabels", componentLabels,
+                 "If this flag is set, the query graph stores the strongly connected component of every vertex and EH queries whose target cannot be reached by the component order return right away");
+
+    unsigned numLandmarks = 0;
+    cp.add_unsigned ("landmarks", numLandmarks,
+                     "If set, EH queries do not relax vertices whose distance plus the ALT lower bound of this many landmarks cannot beat the best path found so far. Set 0 to disable. (default: 0)");
+
+    std::string landmarkSelectionName = "avoid";
+    cp.add_string ("landmarkSelection", landmarkSelectionName,
+                   "How landmarks are chosen: random, farthest or avoid (default: avoid)");
+
+    bool compareLandmarks = false;
+    cp.add_bool ("compareLandmarks", compareLandmarks,
+                 "If this flag is set, the benchmark is run both without and with landmarks. With dijkstraRank, a report of query times and vertices settled per rank is printed");
+
+    std::string hubLabelFilename;
+    cp.add_string ("hubLabels", hubLabelFilename,
+                   "If set, hub labels are built from the EH search spaces (or read if the file exists and rebuild is not set), written to this file, memory mapped and benchmarked after the EH queries");
+
+    double approximationEpsilon = 0;
+    cp.add_double ("approximate", approximationEpsilon,
+                   "If set, EH queries stop each direction once its queue minimum times 1 + this value is at least the best path found, which returns distances of at most 1 + this value times the shortest one (default: 0)");
+
+    bool compareApproximate = false;
+    cp.add_bool ("compareApproximate", compareApproximate,
+                 "If this flag is set, the benchmark is run both exactly and approximately. With dijkstraRank, a report of the speedup and the errors per rank is printed");
+
+    unsigned numTransitNodes = 0;
+    cp.add_unsigned ("transitNodes", numTransitNodes,
+                     "If set, at least this many endpoints of the highest ranked edges become transit nodes. Queries whose restricted searches do not meet are answered by a distance table between them, the others by the EH query. Set 0 to disable. (default: 0)");
+
+    unsigned numTransitNodeCells = TRANSIT_NODES_DEFAULT_CELLS;
+    cp.add_unsigned ("transitNodeCells", numTransitNodeCells,
+                     "Number of cells of consecutive vertices the transit node locality filter records the restricted searches in. More cells make fewer queries local and cost about numCells / 4 bytes per vertex. (default: 256)");
+
+    bool largestComponent = false;
+    cp.add_bool ("largestComponent", largestComponent,
+                 "If this flag is set, the input graph is restricted to its largest strongly connected component before anything else is done with it");
+
+    std::string stallCandidateOrderName;
+    cp.add_string ("stallCandidates", stallCandidateOrderName,
+                   "If set, EH backward stalling only checks a short list of edges per vertex: the lightest ones (weight) or the ones that stalled most often on sample queries (sample)");
+
+    unsigned maxStallCandidates = 4;
+    cp.add_unsigned ("maxStallCandidates", maxStallCandidates,
+                     "Maximum number of stall candidates per vertex and direction (default: 4)");
+
+    unsigned numStallSampleQueries = 1000;
+    cp.add_unsigned ("stallSampleQueries", numStallSampleQueries,
+                     "Number of random queries used to find the sample stall candidates and to calibrate stalling budgets (default: 1000)");
+
+    bool calibrateStalling = false;
+    cp.add_bool ("calibrateStalling", calibrateStalling,
+                 "If this flag is set, sample queries choose the percentage of edges each vertex checks for EH backward stalling, replacing partialStallingPercent");
+
     bool noTimestamp = false;
     cp.add_bool ("noTimestamp", noTimestamp,
                  "If this flag is set, EH queries will not use timestamp flags but instead reset all distances set after each query");
@@ -505,6 +860,30 @@ int main(int argc, char* argv[]) {
     cp.add_bool ("rebuild", rebuild,
                  "If this flag is set, CH and EH are rebuilt");
 
+    unsigned numPartitions = 0;
+    cp.add_unsigned ("partitions", numPartitions,
+                     "Build the EH of N BFS blocks of the graph in separate processes and stitch them together afterwards. Set 0 to build the EH in one piece. (default: 0)");
+
+    unsigned numWorkers = 1;
+    cp.add_unsigned ("workers", numWorkers,
+                     "Maximum number of worker processes running at the same time (only has effect when partitions are used).");
+
+    bool removeDominated = false;
+    cp.add_bool ("removeDominatedEdges", removeDominated,
+                 "If this flag is set, edges that are longer than the distance between their endpoints are removed from the EH after construction");
+
+    bool undirected = false;
+    cp.add_bool ("undirected", undirected,
+                 "If this flag is set, the input graph has to be symmetric. Edge pairs are ranked together and the query graph stores each edge once for both search directions.");
+
+    std::string edgeStoreFilename;
+    cp.add_string ("edgeStore", edgeStoreFilename,
+                   "If set, the adjacency lists of the construction graph are kept in a memory mapped file at this path.");
+
+    unsigned edgeStoreBudget = 0;
+    cp.add_unsigned ("edgeStoreBudget", edgeStoreBudget,
+                     "Size in MB of the memory mapped edge store above which the adjacency lists of vertices whose edges are all ranked are paged out whenever the store grows. Does not bound the memory of the process (only has effect when edgeStore is set).");
+
     // process command line
     if (!cp.process(argc, argv))
         return -1; // some error occurred and help was always written to user.
@@ -513,22 +892,76 @@ int main(int argc, char* argv[]) {
 
     bool CHStallOnDemand = !CHNoStallOnDemand;
 
+    if(!stallCandidateOrderName.empty() && !EHBackwardStalling) {
+        std::cout << "Error! Stall candidates need EHBackwardStalling" << std::endl;
+        exit(1);
+    }
+    if(calibrateStalling && !EHBackwardStalling) {
+        std::cout << "Error! Stalling calibration needs EHBackwardStalling" << std::endl;
+        exit(1);
+    }
+    if(calibrateStalling && partialStallingPercent == -2) {
+        std::cout << "Error! Stalling calibration replaces partialStallingPercent and cannot be combined with -2" << std::endl;
+        exit(1);
+    }
+    if(compareLandmarks && numLandmarks == 0) {
+        std::cout << "Error! Comparing landmarks needs landmarks > 0" << std::endl;
+        exit(1);
+    }
+    if(compareApproximate && approximationEpsilon <= 0) {
+        std::cout << "Error! Comparing approximate queries needs approximate > 0" << std::endl;
+        exit(1);
+    }
+    if(compareApproximate && compareLandmarks) {
+        std::cout << "Error! compareApproximate and compareLandmarks cannot be combined" << std::endl;
+        exit(1);
+    }
+    const LandmarkSelection landmarkSelection = getLandmarkSelectionFromName(landmarkSelectionName);
+    if(undirected && (addTurnCosts || numPartitions > 1)) {
+        std::cout << "Error! Undirected graphs do not support turn costs or partitions" << std::endl;
+        exit(1);
+    }
+
     shortcutHelperUseCH = useCHForEHConstruction;
 
+    if(!edgeStoreFilename.empty()) {
+        MappedEdgeStore::get().open(edgeStoreFilename, size_t(edgeStoreBudget) << 20);
+    }
+
+    std::string turnCostSuffix = "Turncosts" + std::to_string(uTurnCost);
+    if(junctionTurnCost != 0) {
+        turnCostSuffix += "Junction" + std::to_string(junctionTurnCost);
+    }
+
     std::string edgeHierarchyFilename = filename;
+    if(largestComponent) {
+        edgeHierarchyFilename += "LargestSCC";
+    }
     if(addTurnCosts) {
-        edgeHierarchyFilename += "Turncosts" + std::to_string(uTurnCost);
+        edgeHierarchyFilename += turnCostSuffix;
     }
     edgeHierarchyFilename += "ShortcutCountingRoundsEdgeRanker";
     if(useCHForEHConstruction) {
         edgeHierarchyFilename += "CHForConstruction";
     }
+    if(numPartitions > 1) {
+        edgeHierarchyFilename += "Partitions" + std::to_string(numPartitions);
+    }
+    if(removeDominated) {
+        edgeHierarchyFilename += "NoDominatedEdges";
+    }
+    if(undirected) {
+        edgeHierarchyFilename += "Undirected";
+    }
     edgeHierarchyFilename += ".eh";
 
 
     std::string contractionHierarchyFilename = filename;
+    if(largestComponent) {
+        contractionHierarchyFilename += "LargestSCC";
+    }
     if(addTurnCosts) {
-        contractionHierarchyFilename += "Turncosts" + std::to_string(uTurnCost);
+        contractionHierarchyFilename += turnCostSuffix;
     }
     contractionHierarchyFilename += ".ch";
     EdgeHierarchyGraph g(0);
@@ -548,9 +981,30 @@ int main(int argc, char* argv[]) {
 
         cout << "Input graph has " << g.getNumberOfNodes() << " vertices and " << g.getNumberOfEdges() << " edges" << endl;
 
+        if(largestComponent) {
+            start = chrono::steady_clock::now();
+            g = getLargestComponentGraph(g);
+            end = chrono::steady_clock::now();
+
+            cout << "Restricting to the largest strongly connected component took "
+                 << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+                 << " ms" << endl;
+
+            cout << "Largest strongly connected component has " << g.getNumberOfNodes() << " vertices and " << g.getNumberOfEdges() << " edges" << endl;
+        }
+
+        if(undirected && !g.isSymmetric()) {
+            std::cout << "Error! The input graph is not symmetric" << std::endl;
+            exit(1);
+        }
+
         if(addTurnCosts){
             start = chrono::steady_clock::now();
-            g = g.getTurnCostGraph(uTurnCost);
+            TurnCostTable turnCosts;
+            turnCosts[TURN_THROUGH] = 0;
+            turnCosts[TURN_JUNCTION] = junctionTurnCost;
+            turnCosts[TURN_UTURN] = uTurnCost;
+            g = g.getTurnCostGraph(turnCosts, numThreads);
             end = chrono::steady_clock::now();
 
             cout << "Adding turn costs took "
@@ -586,6 +1040,8 @@ int main(int argc, char* argv[]) {
     RoutingKit::ContractionHierarchyQuery chQuery(ch);
 
     cout << "CH has " << ch.forward.first_out.back() + ch.backward.first_out.back() << " edges" << endl;
+    // RoutingKit ranks are 32 bit, NODE_T need not be
+    std::vector<NODE_T> chRank(ch.rank.begin(), ch.rank.end());
 
     shortcutHelperChQuery = chQuery;
 
@@ -595,46 +1051,363 @@ int main(int argc, char* argv[]) {
     }
     else {
         std::cout << "Building Edge Hierarchy..." << std::endl;
-        buildAndWriteEdgeHierarchy<ShortcutCountingRoundsEdgeRanker>(g, edgeHierarchyFilename);
+        buildAndWriteEdgeHierarchy<ShortcutCountingRoundsEdgeRanker>(g, edgeHierarchyFilename, numPartitions, numWorkers, removeDominated, undirected);
     }
     g.sortEdges();
     cout << "Edge hierarchy graph has " << g.getNumberOfNodes() << " vertices and " << g.getNumberOfEdges() << " edges" << endl;
-    EdgeHierarchyGraphQueryOnly newG(0);
-    if(CHOrder) {
-        newG = g.getReorderedGraph<EdgeHierarchyGraphQueryOnly>(ch.rank);
-        cout << "Reordered edge hierarchy graph has " << newG.getNumberOfNodes() << " vertices and " << newG.getNumberOfEdges() << " edges" << endl;
-    }
-    else{
-        if(DFSPreOrder) {
-            newG = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    std::vector<pair<int32_t, int32_t>> coordinates;
+    if(!coordinateFilename.empty()) {
+        if(addTurnCosts) {
+            std::cout << "Ignoring coordinates since the vertices of the turn cost graph are edges of the input graph" << std::endl;
         }
         else {
-            newG = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, false>();
+            coordinates = readCoordinatesDimacs(coordinateFilename, g.getNumberOfNodes());
         }
-        cout << "DFS ordered edge hierarchy graph has " << newG.getNumberOfNodes() << " vertices and " << newG.getNumberOfEdges() << " edges" << endl;
     }
-    newG.makeConsecutive();
+
+    std::vector<NodeOrder> nodeOrders;
+    if(compareNodeOrders) {
+        for(unsigned order = 0; order < NUM_NODE_ORDERS; ++order) {
+            if(isNodeOrderAvailable(NodeOrder(order), chRank, coordinates)) {
+                nodeOrders.push_back(NodeOrder(order));
+            }
+        }
+    }
+    else if(!nodeOrderName.empty()) {
+        nodeOrders.push_back(getNodeOrderFromName(nodeOrderName));
+    }
+    else if(CHOrder) {
+        nodeOrders.push_back(NODE_ORDER_CH);
+    }
+    else {
+        nodeOrders.push_back(DFSPreOrder ? NODE_ORDER_DFS_PRE : NODE_ORDER_DFS_POST);
+    }
 
     if(!dijkstraRank) {
         queries = GenerateRandomQueries(numQueries, seed, g);
     }
 
+    cpu_set_t initialAffinity;
+    pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &initialAffinity);
 
-    if(EHBackwardStalling && partialStallingPercent == -2) {
-        std::cout << "----------------------------------------" << std::endl;
-        std::cout << "No backward stalling" << std::endl;
-        benchmark(EHForwardStalling, false, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, newG, chQuery, queries, -1);
-        for(float i = 0; i <= 100; i += 10) {
-            std::cout << "----------------------------------------" << std::endl;
-            std::cout << "Stalling " << i << "%" << std::endl;
-            benchmark(EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, newG, chQuery, queries, i);
+    std::vector<EdgeLayout> edgeLayouts;
+    if(compareEdgeLayouts) {
+        for(unsigned layout = 0; layout < NUM_EDGE_LAYOUTS; ++layout) {
+            edgeLayouts.push_back(EdgeLayout(layout));
         }
-        std::cout << "----------------------------------------" << std::endl;
-        std::cout << "Full backward stalling (not partial)" << std::endl;
-        benchmark(EHForwardStalling, true, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, newG, chQuery, queries, -1);
+    }
+    else if(!edgeLayoutName.empty()) {
+        edgeLayouts.push_back(getEdgeLayoutFromName(edgeLayoutName));
+    }
+    else {
+        edgeLayouts.push_back(GROUP_EDGES ? EDGE_LAYOUT_GROUPED : EDGE_LAYOUT_SPLIT);
+    }
+
+    if(quantizeRanks || std::find(edgeLayouts.begin(), edgeLayouts.end(), EDGE_LAYOUT_PACKED) != edgeLayouts.end()
+       || std::find(edgeLayouts.begin(), edgeLayouts.end(), EDGE_LAYOUT_PACKED_16) != edgeLayouts.end()) {
+        auto start = chrono::steady_clock::now();
+        EDGERANK_T numLevels = g.quantizeRanks();
+        auto end = chrono::steady_clock::now();
+        cout << "Quantizing edge ranks into " << numLevels << " levels took "
+             << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+             << " ms" << endl;
+    }
+
+    std::vector<bool> queryStates;
+    if(compareQueryStates) {
+        queryStates = {false, true};
     }
     else {
-        benchmark(EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, newG, chQuery, queries, partialStallingPercent);
+        queryStates = {packedQueryState};
+    }
+
+    std::vector<unsigned> relaxBatchSizes;
+    if(compareRelaxBatchSize) {
+        relaxBatchSizes = {0, relaxBatchSize};
+    }
+    else {
+        relaxBatchSizes = {relaxBatchSize};
+    }
+
+    std::vector<double> approximationEpsilons;
+    if(compareApproximate) {
+        approximationEpsilons = {0, approximationEpsilon};
+    }
+    else {
+        approximationEpsilons = {approximationEpsilon};
+    }
+
+    std::vector<bool> landmarkSettings;
+    if(compareLandmarks) {
+        landmarkSettings = {false, true};
+    }
+    else {
+        landmarkSettings = {numLandmarks > 0};
+    }
+
+    // Labels are indexed by external IDs, so a label file serves every query
+    // graph once it is built
+    bool hubLabelsBuilt = false;
+
+    std::vector<pair<NODE_T, NODE_T>> stallSampleQueries;
+    if(calibrateStalling || (!stallCandidateOrderName.empty() && getStallCandidateOrderFromName(stallCandidateOrderName) == STALL_CANDIDATES_SAMPLE)) {
+        for(auto &sampleQuery : GenerateRandomQueries(numStallSampleQueries, seed + 1, g)) {
+            stallSampleQueries.emplace_back(sampleQuery.source, sampleQuery.target);
+        }
+    }
+
+    std::vector<std::tuple<NodeOrder, EdgeLayout, bool, unsigned, EHMeasurement>> report;
+
+    // g is only kept while building the query graph (in parallel) if it is
+    // needed for another one; otherwise it is released as the query graph is
+    // filled, so that the two are never held in full at the same time
+    const bool keepGraph = nodeOrders.size() * edgeLayouts.size() > 1;
+
+    auto benchmarkQueryGraph = [&] (auto &newG, NodeOrder order, EdgeLayout layout, std::vector<NODE_T> &nodeOrder) {
+        auto start = chrono::steady_clock::now();
+        if(keepGraph) {
+            newG.buildPermuted(g, nodeOrder, numThreads);
+        }
+        else {
+            newG.buildConsecutive(g, nodeOrder);
+        }
+        auto end = chrono::steady_clock::now();
+        cout << "Building reordered query graph took "
+             << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+             << " ms" << endl;
+        cout << "Reordered edge hierarchy graph has " << newG.getNumberOfNodes() << " vertices and " << newG.getNumberOfEdges() << " edges" << endl;
+        const size_t adjacencyBytes = newG.getAdjacencyBytes();
+        cout << "Adjacency arrays take " << adjacencyBytes / 1024 << " KiB" << endl;
+        if(order == NODE_ORDER_HOT_CORE) {
+            NODE_T hotCoreSize = getHotCoreSize(newG.getNumberOfNodes(), hotCorePercent);
+            cout << "Hot core has " << hotCoreSize << " vertices and "
+                 << newG.getEdgeBytesBefore(hotCoreSize) / 1024
+                 << " KiB of adjacency arrays" << endl;
+        }
+
+        if(componentLabels) {
+            start = chrono::steady_clock::now();
+            NODE_T numComponents = newG.computeComponents();
+            end = chrono::steady_clock::now();
+            cout << "Computing " << numComponents << " strongly connected components took "
+                 << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+                 << " ms" << endl;
+        }
+
+        std::unique_ptr<Landmarks> landmarks;
+        if(numLandmarks > 0) {
+            start = chrono::steady_clock::now();
+            landmarks = std::make_unique<Landmarks>(newG, numLandmarks, landmarkSelection, seed + 2);
+            end = chrono::steady_clock::now();
+            cout << "Choosing " << landmarks->getLandmarks().size() << " " << landmarkSelectionNames[landmarkSelection] << " landmarks took "
+                 << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+                 << " ms, their distances take " << landmarks->getBytes() / 1024 << " KiB" << endl;
+        }
+
+        StallCandidates stallCandidates(newG.getNumberOfNodes());
+        if(!stallCandidateOrderName.empty()) {
+            start = chrono::steady_clock::now();
+            if(getStallCandidateOrderFromName(stallCandidateOrderName) == STALL_CANDIDATES_WEIGHT) {
+                stallCandidates.buildByWeight(newG, maxStallCandidates);
+            }
+            else {
+                EdgeHierarchyQueryOnly<false, true, false, false, std::remove_reference_t<decltype(newG)>, PackedQueryState> sampleQuery(newG);
+                stallCandidates.buildFromSampleQueries(sampleQuery, stallSampleQueries, maxStallCandidates);
+            }
+            end = chrono::steady_clock::now();
+            cout << "Building " << stallCandidates.getNumberOfCandidates() << " stall candidates took "
+                 << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+                 << " ms" << endl;
+            ehStallCandidates = &stallCandidates;
+        }
+
+        if(calibrateStalling) {
+            start = chrono::steady_clock::now();
+            EdgeHierarchyQueryOnly<false, true, false, false, std::remove_reference_t<decltype(newG)>, PackedQueryState> sampleQuery(newG);
+            calibrateStallingBudgets(newG, sampleQuery, stallSampleQueries);
+            end = chrono::steady_clock::now();
+            cout << "Calibrating stalling budgets took "
+                 << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+                 << " ms" << endl;
+            ehUseStallingBudgets = true;
+        }
+
+        HubLabels hubLabels;
+        if(!hubLabelFilename.empty()) {
+            if((!rebuild || hubLabelsBuilt) && fileExists(hubLabelFilename)) {
+                cout << "Reading hub labels from " << hubLabelFilename << endl;
+            }
+            else {
+                start = chrono::steady_clock::now();
+                hubLabels.build(newG, numThreads);
+                hubLabels.write(hubLabelFilename);
+                end = chrono::steady_clock::now();
+                cout << "Building hub labels with " << numThreads << " threads took "
+                     << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+                     << " ms" << endl;
+                hubLabelsBuilt = true;
+            }
+            hubLabels.readMapped(hubLabelFilename);
+            const NODE_T n = std::max<NODE_T>(hubLabels.getNumberOfNodes(), 1);
+            cout << "Hub labels have " << hubLabels.getNumberOfEntries(true) / n << " forward and "
+                 << hubLabels.getNumberOfEntries(false) / n << " backward entries per vertex and take "
+                 << hubLabels.getBytes() / 1024 << " KiB, the EH adjacency arrays take "
+                 << adjacencyBytes / 1024 << " KiB" << endl;
+        }
+
+        TransitNodes transitNodes;
+        if(numTransitNodes > 0) {
+            start = chrono::steady_clock::now();
+            transitNodes.build(newG, numTransitNodes, numThreads, numTransitNodeCells);
+            end = chrono::steady_clock::now();
+            const NODE_T n = std::max<NODE_T>(newG.getNumberOfNodes(), 1);
+            cout << "Building " << transitNodes.getNumberOfTransitNodes() << " transit nodes (edge ranks >= " << transitNodes.getRankThreshold() << ") took "
+                 << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+                 << " ms" << endl;
+            cout << "Transit nodes have " << double(transitNodes.getNumberOfAccessNodes(true)) / n << " forward and "
+                 << double(transitNodes.getNumberOfAccessNodes(false)) / n << " backward access nodes per vertex. The table takes "
+                 << transitNodes.getTableBytes() / 1024 << " KiB, the access nodes "
+                 << transitNodes.getAccessNodeBytes() / 1024 << " KiB and the locality filter with "
+                 << transitNodes.getNumberOfCells() << " cells "
+                 << transitNodes.getLocalityFilterBytes() / 1024 << " KiB";
+            if(!hubLabelFilename.empty()) {
+                cout << ", the hub labels take " << hubLabels.getBytes() / 1024 << " KiB";
+            }
+            cout << endl;
+        }
+
+        // Pin only now so that the preprocessing above can use all cores
+        pin_to_core(0);
+
+        for(bool packedQueryState : queryStates) {
+            for(unsigned batchSize : relaxBatchSizes) {
+                ehRelaxBatchSize = batchSize;
+                std::vector<DijkstraRankRunningtime> queriesWithoutLandmarks;
+                std::vector<DijkstraRankRunningtime> exactQueries;
+                for(bool useLandmarks : landmarkSettings) {
+                    ehLandmarks = useLandmarks ? landmarks.get() : nullptr;
+                    for(double epsilon : approximationEpsilons) {
+                        ehApproximationEpsilon = epsilon;
+                        std::cout << "Query state: " << (packedQueryState ? "packed" : "split") << ", relax batch size: " << batchSize << ", landmarks: " << (useLandmarks ? numLandmarks : 0) << ", epsilon: " << epsilon << std::endl;
+                        if(EHBackwardStalling && partialStallingPercent == -2) {
+                            std::cout << "----------------------------------------" << std::endl;
+                            std::cout << "No backward stalling" << std::endl;
+                            benchmark(EHForwardStalling, false, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, newG, chQuery, queries, -1);
+                            for(float i = 0; i <= 100; i += 10) {
+                                std::cout << "----------------------------------------" << std::endl;
+                                std::cout << "Stalling " << i << "%" << std::endl;
+                                benchmark(EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, newG, chQuery, queries, i);
+                            }
+                            std::cout << "----------------------------------------" << std::endl;
+                            std::cout << "Full backward stalling (not partial)" << std::endl;
+                            benchmark(EHForwardStalling, true, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, newG, chQuery, queries, -1);
+                        }
+                        else {
+                            benchmark(EHForwardStalling, EHBackwardStalling, CHStallOnDemand, minimalSearchSpace, dijkstraRank, test, noTimestamp, packedQueryState, newG, chQuery, queries, partialStallingPercent);
+                        }
+                        lastEHMeasurement.adjacencyBytes = adjacencyBytes;
+                        report.emplace_back(order, layout, packedQueryState, batchSize, lastEHMeasurement);
+                        if(epsilon == 0) {
+                            exactQueries = queries;
+                        }
+                    }
+                    if(!useLandmarks) {
+                        queriesWithoutLandmarks = queries;
+                    }
+                }
+                if(compareLandmarks && dijkstraRank) {
+                    printLandmarkReport(queriesWithoutLandmarks, queries);
+                }
+                if(compareApproximate && dijkstraRank) {
+                    printApproximationReport(exactQueries, queries);
+                }
+            }
+        }
+
+        if(!hubLabelFilename.empty()) {
+            std::cout << "----------------------------------------" << std::endl;
+            std::cout << "Hub labels" << std::endl;
+            benchmarkHubLabels(dijkstraRank, test, hubLabels, queries);
+        }
+
+        if(numTransitNodes > 0) {
+            std::cout << "----------------------------------------" << std::endl;
+            std::cout << "Transit nodes" << std::endl;
+            benchmarkTransitNodes(dijkstraRank, test, transitNodes, newG, queries);
+        }
+
+        ehStallCandidates = nullptr;
+        ehLandmarks = nullptr;
+        ehApproximationEpsilon = 0;
+        ehUseStallingBudgets = false;
+        unpin(initialAffinity);
+    };
+
+    for(NodeOrder order : nodeOrders) {
+        auto start = chrono::steady_clock::now();
+        std::vector<NODE_T> nodeOrder = getNodeOrder(order, g, chRank, coordinates, numOrderPartitions, hotCorePercent);
+        auto end = chrono::steady_clock::now();
+        cout << "Computing node order " << nodeOrderNames[order] << " took "
+             << chrono::duration_cast<chrono::milliseconds>(end - start).count()
+             << " ms" << endl;
+
+        for(EdgeLayout layout : edgeLayouts) {
+            std::cout << "========================================" << std::endl;
+            std::cout << "Node order: " << nodeOrderNames[order] << ", edge layout: " << edgeLayoutNames[layout] << std::endl;
+
+            auto benchmarkLayout = [&] (auto layoutConstant) {
+                constexpr EdgeLayout chosenLayout = decltype(layoutConstant)::value;
+                if(undirected) {
+                    if(nodeSummaries) {
+                        std::cout << "Node summaries are not supported by the undirected query graph, running without them" << std::endl;
+                    }
+                    EdgeHierarchyGraphQueryOnlyLayout<chosenLayout, false, true> newG(g.getNumberOfNodes());
+                    benchmarkQueryGraph(newG, order, layout, nodeOrder);
+                    return;
+                }
+                if constexpr(chosenLayout != EDGE_LAYOUT_COMPRESSED) {
+                    if(nodeSummaries) {
+                        EdgeHierarchyGraphQueryOnlyLayout<chosenLayout, true> newG(g.getNumberOfNodes());
+                        benchmarkQueryGraph(newG, order, layout, nodeOrder);
+                        return;
+                    }
+                }
+                else if(nodeSummaries) {
+                    std::cout << "Node summaries are not supported by the compressed layout, running without them" << std::endl;
+                }
+                EdgeHierarchyGraphQueryOnlyLayout<chosenLayout, false> newG(g.getNumberOfNodes());
+                benchmarkQueryGraph(newG, order, layout, nodeOrder);
+            };
+            if(layout == EDGE_LAYOUT_GROUPED) {
+                benchmarkLayout(std::integral_constant<EdgeLayout, EDGE_LAYOUT_GROUPED>());
+            }
+            else if(layout == EDGE_LAYOUT_SPLIT) {
+                benchmarkLayout(std::integral_constant<EdgeLayout, EDGE_LAYOUT_SPLIT>());
+            }
+            else if(layout == EDGE_LAYOUT_RANK_SPLIT) {
+                benchmarkLayout(std::integral_constant<EdgeLayout, EDGE_LAYOUT_RANK_SPLIT>());
+            }
+            else if(layout == EDGE_LAYOUT_INTERLEAVED) {
+                benchmarkLayout(std::integral_constant<EdgeLayout, EDGE_LAYOUT_INTERLEAVED>());
+            }
+            else if(layout == EDGE_LAYOUT_COMPRESSED) {
+                benchmarkLayout(std::integral_constant<EdgeLayout, EDGE_LAYOUT_COMPRESSED>());
+            }
+            else if(layout == EDGE_LAYOUT_PACKED) {
+                benchmarkLayout(std::integral_constant<EdgeLayout, EDGE_LAYOUT_PACKED>());
+            }
+            else {
+                benchmarkLayout(std::integral_constant<EdgeLayout, EDGE_LAYOUT_PACKED_16>());
+            }
+        }
+    }
+
+    if(report.size() > 1) {
+        std::cout << "========================================" << std::endl;
+        std::cout << "Layout report (last configuration run per layout):" << std::endl;
+        for(auto &[order, layout, packed, batchSize, measurement] : report) {
+            std::cout << nodeOrderNames[order] << ", " << edgeLayoutNames[layout] << ", " << (packed ? "packed" : "split") << ", batch " << batchSize << ": " << measurement.averageQueryTime << " us; " << measurement.adjacencyBytes / 1024 << " KiB; " << measurement.cacheMisses << std::endl;
+        }
     }
 
     return 0;
@@ -8,13 +8,33 @@
 
 #pragma once
 #include <cstdint>
+#include <cstdlib>
 #include <limits>
+#include <iostream>
 
-#define NODE_T uint32_t
+// Bit widths of vertex IDs, edge weights and edge ranks (which are also
+// used for edge counts). Each can be set to 16, 32 or 64 at compile time.
+#ifndef EH_NODE_BITS
+#define EH_NODE_BITS 32
+#endif
+#ifndef EH_WEIGHT_BITS
+#define EH_WEIGHT_BITS 32
+#endif
+#ifndef EH_RANK_BITS
+#define EH_RANK_BITS 32
+#endif
+
+#define EH_UINT_16 uint16_t
+#define EH_UINT_32 uint32_t
+#define EH_UINT_64 uint64_t
+#define EH_UINT_EXPAND(bits) EH_UINT_ ## bits
+#define EH_UINT(bits) EH_UINT_EXPAND(bits)
+
+#define NODE_T EH_UINT(EH_NODE_BITS)
 #define NODE_INVALID std::numeric_limits<NODE_T>::max()
-#define EDGEWEIGHT_T uint32_t
+#define EDGEWEIGHT_T EH_UINT(EH_WEIGHT_BITS)
 #define EDGEWEIGHT_INFINITY numeric_limits<EDGEWEIGHT_T>::max()
-#define EDGERANK_T uint32_t
+#define EDGERANK_T EH_UINT(EH_RANK_BITS)
 #define EDGECOUNT_T EDGERANK_T
 #define EDGERANK_INFINIY std::numeric_limits<EDGERANK_T>::max()
 #define EDGEID_T uint64_t
@@ -25,3 +45,24 @@ struct edgeInfo {
     EDGEWEIGHT_T weight;
     EDGERANK_T rank;
 };
+
+// Converts a number read from an input file to T. Exits if it is larger than
+// limit, which defaults to the maximum of T.
+template<typename T>
+T checkedNarrow(uint64_t value, const char *what, uint64_t limit = std::numeric_limits<T>::max()) {
+    if(value > limit) {
+        std::cout << "Error! " << what << " " << value << " exceeds " << limit << ", the limit for " << 8 * sizeof(T) << " bit types (see EH_*_BITS in definitions.h)" << std::endl;
+        exit(1);
+    }
+    return T(value);
+}
+
+// RoutingKit's timestamp flags use 32 bit vertex IDs and its contraction
+// hierarchies also 32 bit distances. Exits if a graph with n vertices cannot
+// be handed to them; usesWeights is set by users that pass on edge weights.
+inline void checkRoutingKitLimits(uint64_t n, const char *user, bool usesWeights = false) {
+    if(n > std::numeric_limits<unsigned>::max() || (usesWeights && sizeof(EDGEWEIGHT_T) > sizeof(unsigned))) {
+        std::cout << "Error! " << user << " uses RoutingKit, which needs at most " << std::numeric_limits<unsigned>::max() << " vertices" << (usesWeights ? " and 32 bit weights" : "") << std::endl;
+        exit(1);
+    }
+}
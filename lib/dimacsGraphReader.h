@@ -11,6 +11,9 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
 
 #include "definitions.h"
 #include "edgeHierarchyGraph.h"
@@ -20,8 +23,7 @@ using namespace std;
 EdgeHierarchyGraph readGraphDimacs(string fileName) {
     std::ifstream infile(fileName);
 
-    NODE_T numVertices;
-    EDGEID_T numEdges;
+    NODE_T numVertices = 0;
     string line;
     while (getline(infile, line)) {
         istringstream iss(line);
@@ -30,7 +32,11 @@ EdgeHierarchyGraph readGraphDimacs(string fileName) {
 
         if(firstSymbol == 'p') {
             string sp;
-            iss >> sp >> numVertices >> numEdges;
+            uint64_t rawNumVertices, rawNumEdges;
+            iss >> sp >> rawNumVertices >> rawNumEdges;
+            // NODE_INVALID is not a vertex ID
+            numVertices = checkedNarrow<NODE_T>(rawNumVertices, "Number of vertices", NODE_INVALID);
+            checkedNarrow<EDGECOUNT_T>(rawNumEdges, "Number of edges");
             break;
         }
     }
@@ -43,9 +49,11 @@ EdgeHierarchyGraph readGraphDimacs(string fileName) {
         if (!(iss >> firstSymbol)) { break; } // error
 
         if(firstSymbol == 'a') {
-            NODE_T u, v;
-            EDGEWEIGHT_T weight;
-            iss >> u >> v >> weight;
+            uint64_t rawU, rawV, rawWeight;
+            iss >> rawU >> rawV >> rawWeight;
+            NODE_T u = checkedNarrow<NODE_T>(rawU, "Vertex ID", numVertices);
+            NODE_T v = checkedNarrow<NODE_T>(rawV, "Vertex ID", numVertices);
+            EDGEWEIGHT_T weight = checkedNarrow<EDGEWEIGHT_T>(rawWeight, "Edge weight", EDGEWEIGHT_INFINITY - 1);
             if(!g.hasEdge(u - 1, v - 1)) {
                 g.addEdge(u - 1, v - 1, weight);
             }
@@ -54,3 +62,40 @@ EdgeHierarchyGraph readGraphDimacs(string fileName) {
 
     return g;
 }
+
+// Reads the vertex coordinates of a DIMACS .co file
+vector<pair<int32_t, int32_t>> readCoordinatesDimacs(string fileName, NODE_T numVertices) {
+    std::ifstream infile(fileName);
+    if(!infile) {
+        std::cout << "Error! Could not open coordinate file " << fileName << std::endl;
+        exit(1);
+    }
+
+    vector<pair<int32_t, int32_t>> coordinates(numVertices);
+    NODE_T numRead = 0;
+    string line;
+    while (getline(infile, line)) {
+        istringstream iss(line);
+        char firstSymbol;
+        if (!(iss >> firstSymbol)) { continue; }
+
+        if(firstSymbol == 'v') {
+            NODE_T v;
+            int32_t x, y;
+            iss >> v >> x >> y;
+            if(v == 0 || v > numVertices) {
+                std::cout << "Error! Coordinate for vertex " << v << " out of range" << std::endl;
+                exit(1);
+            }
+            coordinates[v - 1] = {x, y};
+            ++numRead;
+        }
+    }
+
+    if(numRead != numVertices) {
+        std::cout << "Error! Read " << numRead << " coordinates for " << numVertices << " vertices" << std::endl;
+        exit(1);
+    }
+
+    return coordinates;
+}
@@ -0,0 +1,42 @@
+/*******************************************************************************
+ * lib/dominatedEdgeRemoval.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "definitions.h"
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+
+using namespace std;
+
+// Removes all edges (u, v) that are longer than the distance from u to v.
+// Shortcuts inserted early during construction can become dominated by later
+// weight decreases. A dominated edge is not part of any shortest path, so no
+// query result changes when it is removed. Returns the number of removed
+// edges.
+EDGECOUNT_T removeDominatedEdges(EdgeHierarchyGraph &g) {
+    EdgeHierarchyQuery query(g);
+    vector<pair<NODE_T, NODE_T>> dominatedEdges;
+
+    g.forAllNodes([&] (NODE_T u) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    if(query.getDistance(u, v, weight) < weight) {
+                        dominatedEdges.emplace_back(u, v);
+                    }
+                });
+        });
+
+    for(auto &edge : dominatedEdges) {
+        g.removeEdge(edge.first, edge.second);
+    }
+
+    return dominatedEdges.size();
+}
@@ -11,64 +11,147 @@
 #include <vector>
 #include <utility>
 #include <cassert>
+#include <iostream>
 
 #include "definitions.h"
 #include "edgeHierarchyGraph.h"
 #include "edgeHierarchyQuery.h"
 #include "bipartiteMinimumVertexCover.h"
 #include "shortcutHelper.h"
+#include "mappedEdgeStore.h"
 
 using namespace std;
 
-template <class EdgeRanker>
+// With undirected, g has to be symmetric. Each edge is then ranked together
+// with its reverse edge: both get the same rank, and the shortest paths lost
+// are only computed for one of them and mirrored for the other, which keeps
+// g symmetric.
+template <class EdgeRanker, bool undirected = false>
 class EdgeHierarchyConstruction {
 public:
-    EdgeHierarchyConstruction(EdgeHierarchyGraph &g, EdgeHierarchyQuery &query) : g(g), query(query), edgeRanker(g), bipartiteMVC(g.getNumberOfNodes()) {}
+    template<typename... EdgeRankerArgs>
+    EdgeHierarchyConstruction(EdgeHierarchyGraph &g, EdgeHierarchyQuery &query, EdgeRankerArgs&&... edgeRankerArgs) : g(g), query(query), edgeRanker(g, std::forward<EdgeRankerArgs>(edgeRankerArgs)...), bipartiteMVC(g.getNumberOfNodes()) {}
 
     void setEdgeRank(NODE_T u, NODE_T v, EDGERANK_T level) {
         assert(g.getEdgeRank(u, v) == EDGERANK_INFINIY);
         // g.decreaseEdgeWeight(u, v, query.getDistance(u, v));
         g.setEdgeRank(u, v, level);
+        edgeRanked(u, v);
         EDGEWEIGHT_T uVWeight = g.getEdgeWeight(u, v);
+        if constexpr(undirected) {
+            if(!g.hasEdge(v, u) || g.getEdgeWeight(v, u) != uVWeight) {
+                std::cout << "Error! Edge (" << u << ", " << v << ") has no reverse edge of the same weight in an undirected construction" << std::endl;
+                exit(1);
+            }
+            assert(g.getEdgeRank(v, u) == EDGERANK_INFINIY);
+            g.setEdgeRank(v, u, level);
+            edgeRanked(v, u);
+        }
         pair<vector<pair<NODE_T, NODE_T>>, vector<tuple<NODE_T, NODE_T, EDGEWEIGHT_T>>> shortestPathsLost = getShortestPathsLost<true>(u, v, uVWeight, g, query);
 
         for(auto edgeToDecrease : shortestPathsLost.second) {
-            g.decreaseEdgeWeight(get<0>(edgeToDecrease), get<1>(edgeToDecrease), get<2>(edgeToDecrease));
-            if(g.getEdgeRank(get<0>(edgeToDecrease), get<1>(edgeToDecrease)) < EDGERANK_INFINIY) {
-                g.setEdgeRank(get<0>(edgeToDecrease), get<1>(edgeToDecrease), EDGERANK_INFINIY);
-                edgeRanker.addEdge(get<0>(edgeToDecrease), get<1>(edgeToDecrease));
-            } else {
-                edgeRanker.updateEdge(get<0>(edgeToDecrease), get<1>(edgeToDecrease));
+            decreaseEdgeWeight(get<0>(edgeToDecrease), get<1>(edgeToDecrease), get<2>(edgeToDecrease));
+            if constexpr(undirected) {
+                decreaseEdgeWeight(get<1>(edgeToDecrease), get<0>(edgeToDecrease), get<2>(edgeToDecrease));
             }
         }
         auto shortcutVertices = bipartiteMVC.getMinimumVertexCover(shortestPathsLost.first);
 
+        // In the undirected case, the reverse of a lost path
+        // vPrime -> v -> u -> uPrime is covered by the reverse shortcuts
         for(auto uPrime : shortcutVertices.first) {
             EDGEWEIGHT_T uPrimeVWeight = g.getEdgeWeight(uPrime, u) + uVWeight;
-            g.addEdge(uPrime, v, uPrimeVWeight);
-            edgeRanker.addEdge(uPrime, v);
+            addShortcut(uPrime, v, uPrimeVWeight);
+            if constexpr(undirected) {
+                addShortcut(v, uPrime, uPrimeVWeight);
+            }
         }
         for(auto vPrime : shortcutVertices.second) {
             EDGEWEIGHT_T uVPrimeWeight = uVWeight + g.getEdgeWeight(v, vPrime);
-            g.addEdge(u, vPrime, uVPrimeWeight);
-            edgeRanker.addEdge(u, vPrime);
+            addShortcut(u, vPrime, uVPrimeWeight);
+            if constexpr(undirected) {
+                addShortcut(vPrime, u, uVPrimeWeight);
+            }
         }
 //        assert(getShortestPathsLost<true>(u, v, uVWeight, g, query).first.size() == 0);
 //        assert(getShortestPathsLost<true>(u, v, uVWeight, g, query).second.size() == 0);
     }
 
-    void run() {
-        EDGECOUNT_T currentRank = 1;
+    // Ranks all edges the edge ranker hands out. Ranks start at firstRank so
+    // that a construction can be continued on a partially ranked graph.
+    void run(EDGERANK_T firstRank = 1) {
+        countUnrankedEdges();
+        EDGECOUNT_T currentRank = firstRank;
         while(edgeRanker.hasNextEdge()) {
             auto nextEdge = edgeRanker.getNextEdge();
+            if constexpr(undirected) {
+                // Rankers that are not aware of undirected graphs hand out
+                // both edges of a pair
+                if(g.getEdgeRank(nextEdge.first, nextEdge.second) != EDGERANK_INFINIY) {
+                    continue;
+                }
+            }
             setEdgeRank(nextEdge.first, nextEdge.second, currentRank++);
         }
     }
 
 protected:
+    void decreaseEdgeWeight(NODE_T u, NODE_T v, EDGEWEIGHT_T weight) {
+        g.decreaseEdgeWeight(u, v, weight);
+        if(g.getEdgeRank(u, v) < EDGERANK_INFINIY) {
+            g.setEdgeRank(u, v, EDGERANK_INFINIY);
+            edgeUnranked(u, v);
+            edgeRanker.addEdge(u, v);
+        } else {
+            edgeRanker.updateEdge(u, v);
+        }
+    }
+
+    void addShortcut(NODE_T u, NODE_T v, EDGEWEIGHT_T weight) {
+        g.addEdge(u, v, weight);
+        edgeUnranked(u, v);
+        edgeRanker.addEdge(u, v);
+    }
+
+    // With a mapped edge store, the adjacency lists of a vertex are marked
+    // cold as soon as all of its edges are ranked
+    void countUnrankedEdges() {
+        numUnrankedEdges.clear();
+        if(!MappedEdgeStore::get().isActive()) {
+            return;
+        }
+        numUnrankedEdges.assign(g.getNumberOfNodes(), 0);
+        g.forAllNodes([&] (NODE_T u) {
+                g.forAllNeighborsOutWithHighRank(u, EDGERANK_INFINIY, [&] (NODE_T v, EDGERANK_T, EDGEWEIGHT_T) {
+                        edgeUnranked(u, v);
+                    });
+            });
+    }
+
+    void edgeUnranked(NODE_T u, NODE_T v) {
+        if(!numUnrankedEdges.empty()) {
+            ++numUnrankedEdges[u];
+            ++numUnrankedEdges[v];
+        }
+    }
+
+    void edgeRanked(NODE_T u, NODE_T v) {
+        if(numUnrankedEdges.empty()) {
+            return;
+        }
+        for(NODE_T w : {u, v}) {
+            if(--numUnrankedEdges[w] == 0) {
+                g.markAdjacencyCold(w);
+            }
+        }
+    }
+
     EdgeHierarchyGraph &g;
     EdgeHierarchyQuery &query;
     EdgeRanker edgeRanker;
     BipartiteMinimumVertexCover bipartiteMVC;
+    // Unranked edges incident to each vertex, empty without a mapped edge
+    // store
+    vector<EDGECOUNT_T> numUnrankedEdges;
 };
 
@@ -11,13 +11,27 @@
 #include <vector>
 #include <cassert>
 #include <numeric>
+#include <algorithm>
+#include <iostream>
+#include <array>
 
 
 
 #include "definitions.h"
+#include "mappedEdgeStore.h"
+#include "parallelFor.h"
 
 using namespace std;
 
+enum TurnType {
+    TURN_THROUGH = 0, // the only way to continue without turning around
+    TURN_JUNCTION,    // one of several ways to continue
+    TURN_UTURN,
+    NUM_TURN_TYPES
+};
+
+typedef std::array<EDGEWEIGHT_T, NUM_TURN_TYPES> TurnCostTable;
+
 class EdgeHierarchyGraph {
 public:
     EdgeHierarchyGraph(NODE_T n) : n(n), m(0), neighborsOut(n), neighborsIn(n), edgesSorted(false), nodeMap(n), reverseNodeMap(n) {
@@ -64,6 +78,23 @@ public:
         neighborsIn[v].push_back({u, weight, EDGERANK_INFINIY});
     }
 
+    void removeEdge(NODE_T u, NODE_T v) {
+        assert(hasEdge(u, v));
+        --m;
+        for(size_t i = 0; i < neighborsOut[u].size(); ++i) {
+            if(neighborsOut[u][i].neighbor == v) {
+                neighborsOut[u].erase(neighborsOut[u].begin() + i);
+                break;
+            }
+        }
+        for(size_t i = 0; i < neighborsIn[v].size(); ++i) {
+            if(neighborsIn[v][i].neighbor == u) {
+                neighborsIn[v].erase(neighborsIn[v].begin() + i);
+                break;
+            }
+        }
+    }
+
     void decreaseEdgeWeight(NODE_T u, NODE_T v, EDGEWEIGHT_T weight) {
         assert(hasEdge(u, v));
         if(getEdgeWeight(u,v) < weight){
@@ -130,6 +161,33 @@ public:
         return EDGEWEIGHT_INFINITY;
     }
 
+    // Whether every edge has a reverse edge of the same weight and rank, as
+    // required for an undirected construction and query graph
+    bool isSymmetric() {
+        for(NODE_T u = 0; u < n; ++u) {
+            for(const auto &edge : neighborsOut[u]) {
+                bool found = false;
+                for(const auto &reverseEdge : neighborsOut[edge.neighbor]) {
+                    if(reverseEdge.neighbor == u) {
+                        found = reverseEdge.weight == edge.weight && reverseEdge.rank == edge.rank;
+                        break;
+                    }
+                }
+                if(!found) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Tells the mapped edge store that the adjacency lists of v will not be
+    // touched again soon
+    void markAdjacencyCold(NODE_T v) {
+        MappedEdgeStore::get().markCold(neighborsOut[v].data(), neighborsOut[v].capacity() * sizeof(edgeInfo));
+        MappedEdgeStore::get().markCold(neighborsIn[v].data(), neighborsIn[v].capacity() * sizeof(edgeInfo));
+    }
+
     template<typename F>
     void forAllNeighborsIn(NODE_T v, F &&callback) {
         for(size_t i = 0; i < neighborsIn[v].size(); ++i) {
@@ -187,6 +245,30 @@ public:
         }
     }
 
+    // Calls callback(u, v, weight, rank) for all edges (u, v) grouped by u and
+    // frees the outgoing adjacency list of each vertex right after visiting it
+    template<typename F>
+    void forAllEdgesOutAndRelease(F &&callback) {
+        for(NODE_T u = 0; u < n; ++u) {
+            for(const auto &edge : neighborsOut[u]) {
+                callback(u, edge.neighbor, edge.weight, edge.rank);
+            }
+            edgeList().swap(neighborsOut[u]);
+        }
+    }
+
+    // Calls callback(v, u, weight, rank) for all edges (u, v) grouped by v and
+    // frees the incoming adjacency list of each vertex right after visiting it
+    template<typename F>
+    void forAllEdgesInAndRelease(F &&callback) {
+        for(NODE_T v = 0; v < n; ++v) {
+            for(const auto &edge : neighborsIn[v]) {
+                callback(v, edge.neighbor, edge.weight, edge.rank);
+            }
+            edgeList().swap(neighborsIn[v]);
+        }
+    }
+
     template<typename F>
     void forAllNodes(F &&callback) {
         for(NODE_T v = 0; v < n; ++v) {
@@ -207,64 +289,231 @@ public:
         edgesSorted = true;
     }
 
+    // Replaces the edge ranks by the fewest levels that keep the order of
+    // every two edges sharing a vertex, which are the only ranks a query
+    // compares. In increasing order of rank, edge (u, v) gets the lowest
+    // level above all levels already given to edges at u or v. Edges of
+    // equal rank share a level. Returns the number of levels.
+    EDGERANK_T quantizeRanks() {
+        struct rankedEdge {
+            EDGERANK_T rank;
+            NODE_T u;
+            EDGECOUNT_T position;
+        };
+        vector<rankedEdge> rankedEdges;
+        rankedEdges.reserve(m);
+        for(NODE_T u = 0; u < n; ++u) {
+            for(size_t i = 0; i < neighborsOut[u].size(); ++i) {
+                rankedEdges.push_back({neighborsOut[u][i].rank, u, EDGECOUNT_T(i)});
+            }
+        }
+        std::sort(rankedEdges.begin(), rankedEdges.end(), [] (const rankedEdge &a, const rankedEdge &b) {
+                return a.rank < b.rank;
+            });
+
+        // Lowest level the next edge at a vertex may get
+        vector<EDGERANK_T> nextLevel(n, 0);
+        EDGERANK_T numLevels = 0;
+        for(size_t i = 0; i < rankedEdges.size();) {
+            size_t end = i;
+            EDGERANK_T level = 0;
+            for(; end < rankedEdges.size() && rankedEdges[end].rank == rankedEdges[i].rank; ++end) {
+                const NODE_T u = rankedEdges[end].u;
+                const NODE_T v = neighborsOut[u][rankedEdges[end].position].neighbor;
+                level = std::max({level, nextLevel[u], nextLevel[v]});
+            }
+            for(size_t j = i; j < end; ++j) {
+                const NODE_T u = rankedEdges[j].u;
+                edgeInfo &edge = neighborsOut[u][rankedEdges[j].position];
+                edge.rank = level;
+                nextLevel[u] = level + 1;
+                nextLevel[edge.neighbor] = level + 1;
+            }
+            numLevels = std::max<EDGERANK_T>(numLevels, level + 1);
+            i = end;
+        }
+
+        for(NODE_T v = 0; v < n; ++v) {
+            for(auto &edge : neighborsIn[v]) {
+                for(const auto &outEdge : neighborsOut[edge.neighbor]) {
+                    if(outEdge.neighbor == v) {
+                        edge.rank = outEdge.rank;
+                        break;
+                    }
+                }
+            }
+        }
+        return numLevels;
+    }
+
     EdgeHierarchyGraph getTurnCostGraph(unsigned uTurnCost) {
-        std::vector<EDGEID_T> outDegree(n + 1);
-        outDegree[0] = 0;
+        TurnCostTable turnCosts = {};
+        turnCosts[TURN_UTURN] = uTurnCost;
+        return getTurnCostGraph(turnCosts, getDefaultNumThreads());
+    }
+
+    // Classifies the turn from edge (u, v) into edge (v, x), where numExits
+    // is the number of edges leaving v other than (v, u)
+    static TurnType getTurnType(NODE_T u, NODE_T x, NODE_T numExits) {
+        if(x == u) {
+            return TURN_UTURN;
+        }
+        return numExits <= 1 ? TURN_THROUGH : TURN_JUNCTION;
+    }
+
+    // Returns the edge based graph: every edge (u, v) becomes a vertex, and
+    // every turn from (u, v) into (v, x) becomes an edge whose weight is the
+    // weight of (u, v) plus the cost of the turn type. The adjacency lists are
+    // sized up front and filled in parallel, each thread owning the lists of
+    // the vertices it writes to.
+    EdgeHierarchyGraph getTurnCostGraph(const TurnCostTable &turnCosts, unsigned numThreads) {
+        std::vector<EDGEID_T> nodeBegin(n + 1);
+        nodeBegin[0] = 0;
+        uint64_t numTurns = 0;
         forAllNodes([&] (NODE_T v) {
-                outDegree[v + 1] = getOutDegree(v);
+                nodeBegin[v + 1] = nodeBegin[v] + getOutDegree(v);
+                numTurns += uint64_t(getInDegree(v)) * getOutDegree(v);
             });
 
-        std::vector<EDGEID_T> nodeBegin(n + 1);
-        std::partial_sum(outDegree.begin(), outDegree.end(), nodeBegin.begin());
+        if(nodeBegin.back() >= NODE_INVALID || numTurns > std::numeric_limits<EDGECOUNT_T>::max()) {
+            std::cout << "Error! Turn cost graph with " << nodeBegin.back() << " vertices and " << numTurns << " edges does not fit into NODE_T and EDGECOUNT_T" << std::endl;
+            exit(1);
+        }
+        EDGEWEIGHT_T maxTurnCost = *std::max_element(turnCosts.begin(), turnCosts.end());
+        forAllNodes([&] (NODE_T u) {
+                forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                        if(weight > EDGEWEIGHT_INFINITY - 1 - maxTurnCost) {
+                            std::cout << "Error! Weight " << weight << " of edge (" << u << ", " << v << ") overflows when adding turn costs" << std::endl;
+                            exit(1);
+                        }
+                    });
+            });
 
         EdgeHierarchyGraph result(nodeBegin.back());
+        result.m = numTurns;
 
+        // Tail and vertex ID in the turn cost graph of the edges entering each vertex
+        std::vector<std::vector<std::pair<NODE_T, NODE_T>>> incomingEdges(n);
         forAllNodes([&] (NODE_T u) {
-                EDGECOUNT_T uNeighborCounter = 0;
-                forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T originalWeight) {
-                        NODE_T uNew = nodeBegin[u] + uNeighborCounter;
-                        EDGECOUNT_T vNeighborCounter = 0;
-                        forAllNeighborsOut(v, [&] (NODE_T x, EDGEWEIGHT_T ignoreWeight) {
-                                NODE_T vNew = nodeBegin[v] + vNeighborCounter;
-                                EDGEWEIGHT_T newWeight = originalWeight;
-                                if(x == u) {
-                                    newWeight += uTurnCost;
-                                }
-                                result.addEdge(uNew, vNew, newWeight);
-                                ++vNeighborCounter;
-                            });
-                        ++uNeighborCounter;
-                    });
+                for(size_t i = 0; i < neighborsOut[u].size(); ++i) {
+                    incomingEdges[neighborsOut[u][i].neighbor].emplace_back(u, nodeBegin[u] + i);
+                }
             });
 
-        return result;
+        // Number of exits of every edge (u, v) for getTurnType, indexed by its
+        // vertex ID in the turn cost graph. The out-neighbors of each v are
+        // marked once, so finding the reverse edges takes linear time.
+        std::vector<NODE_T> numExits(nodeBegin.back());
+        std::vector<NODE_T> markedBy(n, NODE_INVALID);
+        forAllNodes([&] (NODE_T v) {
+                for(const edgeInfo &edge : neighborsOut[v]) {
+                    markedBy[edge.neighbor] = v;
+                }
+                for(auto [u, uNew] : incomingEdges[v]) {
+                    numExits[uNew] = getOutDegree(v) - (markedBy[u] == v ? 1 : 0);
+                }
+            });
+
+        parallelFor(0, n, numThreads, [&] (NODE_T u) {
+                for(size_t i = 0; i < neighborsOut[u].size(); ++i) {
+                    const NODE_T v = neighborsOut[u][i].neighbor;
+                    const EDGEWEIGHT_T originalWeight = neighborsOut[u][i].weight;
+                    edgeList &turns = result.neighborsOut[nodeBegin[u] + i];
+                    turns.reserve(neighborsOut[v].size());
+                    for(size_t j = 0; j < neighborsOut[v].size(); ++j) {
+                        const NODE_T x = neighborsOut[v][j].neighbor;
+                        turns.push_back({NODE_T(nodeBegin[v] + j), EDGEWEIGHT_T(originalWeight + turnCosts[getTurnType(u, x, numExits[nodeBegin[u] + i])]), EDGERANK_INFINIY});
+                    }
+                }
+            });
 
+        parallelFor(0, n, numThreads, [&] (NODE_T v) {
+                for(size_t j = 0; j < neighborsOut[v].size(); ++j) {
+                    const NODE_T x = neighborsOut[v][j].neighbor;
+                    edgeList &turns = result.neighborsIn[nodeBegin[v] + j];
+                    turns.reserve(neighborsIn[v].size());
+                    for(auto [u, uNew] : incomingEdges[v]) {
+                        const EDGEWEIGHT_T originalWeight = neighborsOut[u][uNew - nodeBegin[u]].weight;
+                        turns.push_back({uNew, EDGEWEIGHT_T(originalWeight + turnCosts[getTurnType(u, x, numExits[uNew])]), EDGERANK_INFINIY});
+                    }
+                }
+            });
+
+        return result;
     }
 
     template<typename T>
-    T getReorderedGraph(std::vector<NODE_T> perm) {
+    T getReorderedGraph(std::vector<NODE_T> perm, unsigned numThreads = getDefaultNumThreads()) {
         if(perm.size() != n) {
             std::cout << "Error! given order has wrong size!" << std::endl;
             exit(1);
         }
         auto result = T(n);
+        result.buildPermuted(*this, perm, numThreads);
+
+        return result;
+    }
 
+    template<typename T, bool preOrder>
+    T getDFSOrderGraph(unsigned numThreads = getDefaultNumThreads()) {
+        return getReorderedGraph<T>(getDFSOrder<preOrder>(), numThreads);
+    }
 
-        forAllNodes([&] (NODE_T v) {
-                forAllNeighborsOut(v, [&] (NODE_T w, EDGEWEIGHT_T weight) {
-                        result.addEdge(perm[v], perm[w], weight);
-                        result.setEdgeRank(perm[v], perm[w], getEdgeRank(v, w));
+    // Returns the inverse of perm and checks that it is a permutation
+    std::vector<NODE_T> getInversePermutation(const std::vector<NODE_T> &perm) {
+        std::vector<NODE_T> inverse(n, NODE_INVALID);
+        for(NODE_T v = 0; v < n; ++v) {
+            if(perm[v] >= n || inverse[perm[v]] != NODE_INVALID) {
+                std::cout << "Error! given order is not a permutation!" << std::endl;
+                exit(1);
+            }
+            inverse[perm[v]] = v;
+        }
+        return inverse;
+    }
+
+    // Fills this graph with the edges of g, renumbering vertex v to perm[v].
+    // Every vertex owns its adjacency lists, so they are copied and sorted by
+    // rank in parallel without looking up single edges.
+    template<typename G>
+    void buildPermuted(G &g, const std::vector<NODE_T> &perm, unsigned numThreads) {
+        if(g.getNumberOfNodes() != n || perm.size() != n) {
+            std::cout << "Error! given order has wrong size!" << std::endl;
+            exit(1);
+        }
+        std::vector<NODE_T> original = getInversePermutation(perm);
+        m = g.getNumberOfEdges();
+
+        auto byRank = [] (const edgeInfo &i, const edgeInfo &j) {
+            return i.rank > j.rank;
+        };
+        parallelFor(0, n, numThreads, [&] (NODE_T newV) {
+                const NODE_T v = original[newV];
+                edgeList &out = neighborsOut[newV];
+                out.clear();
+                out.reserve(g.getOutDegree(v));
+                g.forAllNeighborsOutWithHighRank(v, 0, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                        out.push_back({perm[w], weight, rank});
                     });
+                std::stable_sort(out.begin(), out.end(), byRank);
+
+                edgeList &in = neighborsIn[newV];
+                in.clear();
+                in.reserve(g.getInDegree(v));
+                g.forAllNeighborsInWithHighRank(v, 0, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                        in.push_back({perm[w], weight, rank});
+                    });
+                std::stable_sort(in.begin(), in.end(), byRank);
             });
-        result.setNodeMap(perm);
 
-        return result;
+        edgesSorted = true;
+        std::vector<NODE_T> newNodeMap = perm;
+        setNodeMap(newNodeMap);
     }
 
-    template<typename T, bool preOrder>
-    T getDFSOrderGraph() {
-        auto result = T(n);
-
+    // Returns the DFS number of each vertex
+    template<bool preOrder>
+    std::vector<NODE_T> getDFSOrder() {
         NODE_T dfsCount = 0;
         std::vector<NODE_T> dfsNum(n, NODE_INVALID);
         std::vector<bool> marks(n, false);
@@ -275,13 +524,11 @@ public:
 
         std::vector<NODE_T> stack;
 
-        while(!std::all_of(marks.begin(), marks.end(), [](bool v) { return v; })) {
-            for(NODE_T v = 0; v < n; ++v) {
-                if(!marks[v]) {
-                    stack.push_back(v);
-                    break;
-                }
+        for(NODE_T root = 0; root < n; ++root) {
+            if(marks[root]) {
+                continue;
             }
+            stack.push_back(root);
 
             while(!stack.empty()) {
                 NODE_T v = stack.back();
@@ -315,16 +562,7 @@ public:
             exit(1);
         }
 
-
-        forAllNodes([&] (NODE_T v) {
-                forAllNeighborsOut(v, [&] (NODE_T w, EDGEWEIGHT_T weight) {
-                        result.addEdge(dfsNum[v], dfsNum[w], weight);
-                        result.setEdgeRank(dfsNum[v], dfsNum[w], getEdgeRank(v, w));
-                    });
-            });
-        result.setNodeMap(dfsNum);
-
-        return result;
+        return dfsNum;
     }
 
     void DFS(NODE_T v, std::vector<bool> &marks, std::vector<NODE_T> &dfsNum, NODE_T &dfsCount) {
@@ -345,8 +583,8 @@ public:
 protected:
     NODE_T n;
     EDGECOUNT_T m;
-    vector<vector<edgeInfo>> neighborsOut;
-    vector<vector<edgeInfo>> neighborsIn;
+    vector<edgeList, MappedEdgeStoreAllocator<edgeList>> neighborsOut;
+    vector<edgeList, MappedEdgeStoreAllocator<edgeList>> neighborsIn;
     bool edgesSorted;
     vector<NODE_T> nodeMap;
     vector<NODE_T> reverseNodeMap;
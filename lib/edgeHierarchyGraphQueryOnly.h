@@ -11,18 +11,183 @@
 #include <vector>
 #include <cassert>
 #include <numeric>
+#include <algorithm>
+#include <string>
+#include <iostream>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 
 #include "definitions.h"
+#include "parallelFor.h"
+#include "stronglyConnectedComponents.h"
 
 #define GROUP_EDGES true
 
+// Rank ranges longer than this are binary searched for the cutoff rank
+// instead of scanned
+#define RANK_CUTOFF_BINARY_SEARCH_THRESHOLD 64
+
 using namespace std;
 
+// Memory layouts of the adjacency arrays of the query graph
+enum EdgeLayout {
+    EDGE_LAYOUT_GROUPED = 0, // one array of (neighbor, weight, rank)
+    EDGE_LAYOUT_SPLIT,       // separate arrays of neighbors, weights and ranks
+    EDGE_LAYOUT_RANK_SPLIT,  // an array of ranks and one of (neighbor, weight)
+    EDGE_LAYOUT_INTERLEAVED, // outgoing edges of a vertex directly followed by its incoming edges
+    EDGE_LAYOUT_COMPRESSED,  // varint encoded byte stream per adjacency range, decoded while scanning
+    EDGE_LAYOUT_PACKED,      // one array of 8 byte (neighbor, 24 bit weight, 8 bit rank level)
+    EDGE_LAYOUT_PACKED_16,   // one array of 8 byte (neighbor, 16 bit weight, 16 bit rank level)
+    NUM_EDGE_LAYOUTS
+};
+
+const char *const edgeLayoutNames[NUM_EDGE_LAYOUTS] = {"grouped", "split", "ranksplit", "interleaved", "compressed", "packed", "packed16"};
+
+EdgeLayout getEdgeLayoutFromName(const string &name) {
+    for(unsigned layout = 0; layout < NUM_EDGE_LAYOUTS; ++layout) {
+        if(name == edgeLayoutNames[layout]) {
+            return EdgeLayout(layout);
+        }
+    }
+    std::cout << "Error! Unknown edge layout " << name << std::endl;
+    exit(1);
+}
+
+// Where the outgoing and incoming edges of a vertex start in the interleaved
+// layout. The incoming edges end where the next vertex starts.
+struct nodeOffsets {
+    EDGECOUNT_T outBegin;
+    EDGECOUNT_T inBegin;
+};
+
+// Compact record of the adjacency ranges of a vertex in both directions.
+// The maximum ranks let a query skip a vertex whose edges are all below its
+// rank threshold without fetching any of its edges.
+struct nodeSummary {
+    EDGECOUNT_T outBegin;
+    EDGECOUNT_T outDegree;
+    EDGERANK_T outMaxRank;
+    EDGECOUNT_T inBegin;
+    EDGECOUNT_T inDegree;
+    EDGERANK_T inMaxRank;
+};
+
+struct neighborWeight {
+    NODE_T neighbor;
+    EDGEWEIGHT_T weight;
+};
+
+#define PACKED_EDGE_WEIGHT_BITS 24
+#define PACKED_16_EDGE_WEIGHT_BITS 16
+
+// Edge of the packed layouts. The rank is stored in the top 8 or 16 bits of
+// weightAndRank, so it has to be quantized into levels first, see
+// EdgeHierarchyGraph::quantizeRanks.
+struct packedEdgeInfo {
+    NODE_T neighbor;
+    uint32_t weightAndRank;
+};
 
-class EdgeHierarchyGraphQueryOnly {
+// Neighbors and weights of an adjacency range as seen by vectorized scans:
+// edge i has neighbor neighbors[i * neighborStride] and weight
+// weights[i * weightStride] & weightMask. The strides only differ if NODE_T
+// and EDGEWEIGHT_T have different widths. The mask strips the rank level
+// from the edges of the packed layouts.
+struct neighborWeightRange {
+    const NODE_T *neighbors;
+    const EDGEWEIGHT_T *weights;
+    size_t neighborStride;
+    size_t weightStride;
+    size_t size;
+    EDGEWEIGHT_T weightMask = EDGEWEIGHT_INFINITY;
+
+    NODE_T getNeighbor(size_t i) const {
+        return neighbors[i * neighborStride];
+    }
+
+    EDGEWEIGHT_T getWeight(size_t i) const {
+        return weights[i * weightStride] & weightMask;
+    }
+};
+
+// Returns the first position in [begin, end) whose rank is less than
+// rankThreshold, given ranks sorted in descending order. Short ranges are
+// scanned, eight ranks at a time if AVX2 is available, long ones are binary
+// searched.
+inline size_t findRankCutoff(const EDGERANK_T *ranks, size_t begin, size_t end, const EDGERANK_T rankThreshold) {
+    if(end - begin > RANK_CUTOFF_BINARY_SEARCH_THRESHOLD) {
+        return std::partition_point(ranks + begin, ranks + end, [&] (EDGERANK_T rank) {
+                return rank >= rankThreshold;
+            }) - ranks;
+    }
+    size_t i = begin;
+#ifdef __AVX2__
+    if constexpr(sizeof(EDGERANK_T) == 4) {
+        const __m256i threshold = _mm256_set1_epi32(rankThreshold);
+        for(; i + 8 <= end; i += 8) {
+            const __m256i rank = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ranks + i));
+            // rank >= threshold iff max(rank, threshold) == rank (unsigned)
+            const __m256i isHigh = _mm256_cmpeq_epi32(_mm256_max_epu32(rank, threshold), rank);
+            const unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(isHigh));
+            if(mask != 0xFF) {
+                return i + __builtin_ctz(~mask);
+            }
+        }
+    }
+#endif
+    while(i < end && ranks[i] >= rankThreshold) {
+        ++i;
+    }
+    return i;
+}
+
+// Appends value to bytes, seven bits per byte starting with the least
+// significant ones. The high bit of a byte is set if more bytes follow.
+inline void appendVarint(vector<uint8_t> &bytes, uint64_t value) {
+    while(value >= 0x80) {
+        bytes.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    bytes.push_back(uint8_t(value));
+}
+
+inline uint64_t readVarint(const uint8_t *&position) {
+    uint64_t value = *position & 0x7F;
+    unsigned shift = 7;
+    while(*position++ & 0x80) {
+        value |= uint64_t(*position & 0x7F) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+// Maps signed differences of small magnitude to small unsigned values
+inline uint64_t zigzagEncode(int64_t value) {
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+// An undirected query graph has to be built from a symmetric graph, see
+// EdgeHierarchyGraph::isSymmetric. It stores each vertex's edges once, in the
+// outgoing adjacency arrays, and the forward and backward searches share them.
+template<EdgeLayout layout, bool useNodeSummaries = false, bool undirected = false>
+class EdgeHierarchyGraphQueryOnlyLayout {
+    static_assert(layout != EDGE_LAYOUT_COMPRESSED || !useNodeSummaries, "Node summaries are not supported by the compressed layout");
+    // Direction of the adjacency arrays the incoming edges are read from
+    static constexpr bool inDirection = undirected;
+    static constexpr bool isPacked = layout == EDGE_LAYOUT_PACKED || layout == EDGE_LAYOUT_PACKED_16;
+    // The weight is stored in the low bits of weightAndRank, the rank level
+    // in the remaining ones
+    static constexpr unsigned packedWeightBits = layout == EDGE_LAYOUT_PACKED_16 ? PACKED_16_EDGE_WEIGHT_BITS : PACKED_EDGE_WEIGHT_BITS;
+    static constexpr uint32_t packedWeightMask = (uint32_t(1) << packedWeightBits) - 1;
+    static constexpr uint32_t packedMaxRank = (uint32_t(1) << (32 - packedWeightBits)) - 1;
 public:
-    EdgeHierarchyGraphQueryOnly(NODE_T n) : n(n), m(0), neighborsOut(n), neighborsIn(n), edgesSorted(false), nodeMap(n), reverseNodeMap(n) {
+    EdgeHierarchyGraphQueryOnlyLayout(NODE_T n) : n(n), m(0), neighborsOut(n), neighborsIn(n), edgesSorted(false), nodeMap(n), reverseNodeMap(n) {
         std::iota(std::begin(nodeMap), std::end(nodeMap), 0);
         std::iota(std::begin(reverseNodeMap), std::end(reverseNodeMap), 0);
     }
@@ -43,6 +208,28 @@ public:
         }
     }
 
+    // Number of entries of the incoming and outgoing adjacency arrays that
+    // belong to the vertices with IDs less than v
+    EDGECOUNT_T getNumberOfEdgesBefore(NODE_T v) {
+        if(v == n) {
+            return undirected ? m : 2 * m;
+        }
+        if constexpr(useNodeSummaries) {
+            if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+                return summaries[v].outBegin;
+            }
+            else {
+                return summaries[v].outBegin + summaries[v].inBegin;
+            }
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            return offsets[v].outBegin;
+        }
+        else {
+            return outBegin[v] + inBegin[v];
+        }
+    }
+
     NODE_T getInternalNodeNumber(NODE_T externalNumber) {
         return nodeMap[externalNumber];
     }
@@ -85,126 +272,131 @@ public:
 
     template<typename F>
     void forAllNeighborsInAndStopPartial(NODE_T v, F &&callback, int percent) {
-        const size_t end = inBegin[v] + (((inBegin[v + 1] - inBegin[v]) * percent)/100);
-        for(size_t i = inBegin[v]; i < end; ++i) {
-#if GROUP_EDGES
-            bool stop = callback(inEdges[i].neighbor, inEdges[i].weight);
-#else
-            bool stop = callback(inNeighbor[i], inWeight[i]);
-#endif
-            if(stop) {
-                return;
-            }
-        }
+        forAllNeighborsAndStopPartial<inDirection>(v, callback, percent);
     }
 
     template<typename F>
     void forAllNeighborsInAndStop(NODE_T v, F &&callback) {
-        const size_t end = inBegin[v + 1];
-        for(size_t i = inBegin[v]; i < end; ++i) {
-#if GROUP_EDGES
-            bool stop = callback(inEdges[i].neighbor, inEdges[i].weight);
-#else
-            bool stop = callback(inNeighbor[i], inWeight[i]);
-#endif
-            if(stop) {
-                return;
-            }
-        }
+        forAllNeighborsAndStop<inDirection>(v, callback);
     }
 
     template<typename F>
     void forAllNeighborsOutAndStopPartial(NODE_T v, F &&callback, int percent) {
-        const size_t end = outBegin[v] + (((outBegin[v + 1] - outBegin[v]) * percent)/100);
-        for(size_t i = outBegin[v]; i < end; ++i) {
-#if GROUP_EDGES
-            bool stop = callback(outEdges[i].neighbor, outEdges[i].weight);
-#else
-            bool stop = callback(outNeighbor[i], outWeight[i]);
-#endif
-            if(stop) {
-                return;
-            }
-        }
+        forAllNeighborsAndStopPartial<true>(v, callback, percent);
     }
 
     template<typename F>
     void forAllNeighborsOutAndStop(NODE_T v, F &&callback) {
-        const size_t end = outBegin[v + 1];
-        for(size_t i = outBegin[v]; i < end; ++i) {
-#if GROUP_EDGES
-            bool stop = callback(outEdges[i].neighbor, outEdges[i].weight);
-#else
-            bool stop = callback(outNeighbor[i], outWeight[i]);
-#endif
-            if(stop) {
-                return;
-            }
+        forAllNeighborsAndStop<true>(v, callback);
+    }
+
+    // Whether the adjacency arrays can be handed out as neighbor ranges.
+    // Compressed edges have to be decoded while scanning instead, as do
+    // packed edges if weightAndRank cannot be read as an EDGEWEIGHT_T.
+    static constexpr bool hasNeighborRanges = layout != EDGE_LAYOUT_COMPRESSED && (!isPacked || sizeof(EDGEWEIGHT_T) == sizeof(uint32_t));
+
+    EDGECOUNT_T getInDegree(NODE_T v) {
+        return getEnd<inDirection>(v) - getBegin<inDirection>(v);
+    }
+
+    EDGECOUNT_T getOutDegree(NODE_T v) {
+        return getEnd<true>(v) - getBegin<true>(v);
+    }
+
+    // Neighbors and weights of the first percent percent of the incoming
+    // edges of v, the same edges forAllNeighborsInAndStopPartial visits
+    neighborWeightRange getNeighborRangeIn(NODE_T v, int percent = 100) {
+        return getNeighborRange<inDirection>(v, percent);
+    }
+
+    neighborWeightRange getNeighborRangeOut(NODE_T v, int percent = 100) {
+        return getNeighborRange<true>(v, percent);
+    }
+
+    // Per vertex percentages of the incoming and outgoing edges backward
+    // stalling checks, see stallingCalibration.h
+    void setStallingPercents(vector<uint8_t> &percentsIn, vector<uint8_t> &percentsOut) {
+        stallingPercentIn.swap(percentsIn);
+        stallingPercentOut.swap(percentsOut);
+    }
+
+    int getStallingPercentIn(NODE_T v) {
+        return stallingPercentIn[v];
+    }
+
+    int getStallingPercentOut(NODE_T v) {
+        return stallingPercentOut[v];
+    }
+
+    // Stores the strongly connected component of every vertex so that
+    // queries from a component to one it cannot reach are answered right
+    // away. Returns the number of components.
+    NODE_T computeComponents() {
+        components = getStronglyConnectedComponents(*this);
+        return n == 0 ? 0 : *std::max_element(components.begin(), components.end()) + 1;
+    }
+
+    // False only if v is not reachable from u (internal IDs): the
+    // components are numbered in reverse topological order, so every
+    // component only reaches components with smaller or equal labels.
+    // Always true if computeComponents was not called.
+    bool mayReach(NODE_T u, NODE_T v) {
+        return components.empty() || components[u] >= components[v];
+    }
+
+    // Bytes taken by the adjacency arrays and the per vertex offsets into
+    // them
+    size_t getAdjacencyBytes() {
+        return outBegin.size() * sizeof(EDGECOUNT_T) + inBegin.size() * sizeof(EDGECOUNT_T)
+            + (outEdges.size() + inEdges.size() + edges.size()) * sizeof(edgeInfo)
+            + (outNeighbor.size() + inNeighbor.size()) * sizeof(NODE_T)
+            + (outWeight.size() + inWeight.size()) * sizeof(EDGEWEIGHT_T)
+            + (outRank.size() + inRank.size()) * sizeof(EDGERANK_T)
+            + (outTargets.size() + inTargets.size()) * sizeof(neighborWeight)
+            + offsets.size() * sizeof(nodeOffsets) + summaries.size() * sizeof(nodeSummary)
+            + (outByteBegin.size() + inByteBegin.size()) * sizeof(uint64_t)
+            + outBytes.size() + inBytes.size()
+            + (outPacked.size() + inPacked.size()) * sizeof(packedEdgeInfo);
+    }
+
+    // Bytes taken by the edges of the vertices before v in the edge arrays
+    // counted by getAdjacencyBytes
+    size_t getEdgeBytesBefore(NODE_T v) {
+        if constexpr(layout == EDGE_LAYOUT_COMPRESSED) {
+            return outByteBegin[v] + inByteBegin[v];
+        }
+        else if constexpr(layout == EDGE_LAYOUT_SPLIT) {
+            return size_t(getNumberOfEdgesBefore(v)) * (sizeof(NODE_T) + sizeof(EDGEWEIGHT_T) + sizeof(EDGERANK_T));
+        }
+        else if constexpr(layout == EDGE_LAYOUT_RANK_SPLIT) {
+            return size_t(getNumberOfEdgesBefore(v)) * (sizeof(neighborWeight) + sizeof(EDGERANK_T));
+        }
+        else if constexpr(isPacked) {
+            return size_t(getNumberOfEdgesBefore(v)) * sizeof(packedEdgeInfo);
+        }
+        else {
+            return size_t(getNumberOfEdgesBefore(v)) * sizeof(edgeInfo);
         }
     }
 
     template<typename F>
     void forAllNeighborsInWithRank(NODE_T v, F &&callback) {
-        for(size_t i = inBegin[v]; i < inBegin[v + 1]; ++i) {
-#if GROUP_EDGES
-            callback(inEdges[i].neighbor, inEdges[i].rank, inEdges[i].weight);
-#else
-            callback(inNeighbor[i], inRank[i], inWeight[i]);
-#endif
-        }
+        forAllNeighborsWithRank<inDirection>(v, callback);
     }
 
     template<typename F>
     void forAllNeighborsOutWithRank(NODE_T v, F &&callback) {
-        for(size_t i = outBegin[v]; i < outBegin[v + 1]; ++i) {
-#if GROUP_EDGES
-            callback(outEdges[i].neighbor, outEdges[i].rank, outEdges[i].weight);
-#else
-            callback(outNeighbor[i], outRank[i], outWeight[i]);
-#endif
-        }
+        forAllNeighborsWithRank<true>(v, callback);
     }
 
     template<typename F>
-    void forAllNeighborsInWithHighRank(const NODE_T v, const EDGERANK_T _rankThreshold, F &&callback) {
-        const EDGERANK_T rankThreshold = _rankThreshold;
-        size_t i = inBegin[v];
-        const size_t end = inBegin[v + 1];
-        while(i < end &&
-#if GROUP_EDGES
-              inEdges[i].rank >= rankThreshold
-#else
-              inRank[i] >= rankThreshold
-#endif
-              ){
-#if GROUP_EDGES
-            callback(inEdges[i].neighbor, inEdges[i].rank, inEdges[i].weight);
-#else
-            callback(inNeighbor[i], inRank[i], inWeight[i]);
-#endif
-            ++i;
-        }
+    void forAllNeighborsInWithHighRank(const NODE_T v, const EDGERANK_T rankThreshold, F &&callback) {
+        forAllNeighborsWithHighRank<inDirection>(v, rankThreshold, callback);
     }
 
     template<typename F>
-    void forAllNeighborsOutWithHighRank(const NODE_T v, const EDGERANK_T _rankThreshold, F &&callback) {
-        const EDGERANK_T rankThreshold = _rankThreshold;
-        size_t i = outBegin[v];
-        const size_t end = outBegin[v + 1];
-        while(i < end &&
-#if GROUP_EDGES
-              outEdges[i].rank >= rankThreshold
-#else
-              outRank[i] >= rankThreshold
-#endif
-              ){
-#if GROUP_EDGES
-            callback(outEdges[i].neighbor, outEdges[i].rank, outEdges[i].weight);
-#else
-            callback(outNeighbor[i], outRank[i], outWeight[i]);
-#endif
-            ++i;
-        }
+    void forAllNeighborsOutWithHighRank(const NODE_T v, const EDGERANK_T rankThreshold, F &&callback) {
+        forAllNeighborsWithHighRank<true>(v, rankThreshold, callback);
     }
 
     template<typename F>
@@ -231,81 +423,552 @@ public:
     }
 
     void makeConsecutive() {
+        if(!outBegin.empty() || !offsets.empty() || !summaries.empty()) {
+            // Already built by buildConsecutive or buildPermuted
+            return;
+        }
         sortEdges();
-        outBegin.clear();
-        inBegin.clear();
-#if GROUP_EDGES
-        outEdges.clear();
-        inEdges.clear();
-#else
-        outNeighbor.clear();
-        inNeighbor.clear();
-        outWeight.clear();
-        inWeight.clear();
-        outRank.clear();
-        inRank.clear();
-#endif
+        outBegin.assign(n + 1, 0);
+        inBegin.assign(n + 1, 0);
         forAllNodes([&] (NODE_T v) {
-#if GROUP_EDGES
-                outBegin.push_back(outEdges.size());
-                inBegin.push_back(inEdges.size());
-#else
-                outBegin.push_back(outNeighbor.size());
-                inBegin.push_back(inNeighbor.size());
-#endif
-                for(const auto &edge: neighborsOut[v]) {
-#if GROUP_EDGES
-                    outEdges.push_back(edge);
-#else
-                    outNeighbor.push_back(edge.neighbor);
-                    outWeight.push_back(edge.weight);
-                    outRank.push_back(edge.rank);
-#endif
-                }
+                outBegin[v + 1] = neighborsOut[v].size();
+                inBegin[v + 1] = neighborsIn[v].size();
+            });
+        setBeginFromDegrees();
+        resizeEdges(m);
 
-                for(const auto &edge: neighborsIn[v]) {
-#if GROUP_EDGES
-                    inEdges.push_back(edge);
-#else
-                    inNeighbor.push_back(edge.neighbor);
-                    inWeight.push_back(edge.weight);
-                    inRank.push_back(edge.rank);
-#endif
+        forAllNodes([&] (NODE_T v) {
+                for(size_t i = 0; i < neighborsOut[v].size(); ++i) {
+                    setEdgeAt<true>(outBegin[v] + i, neighborsOut[v][i]);
+                }
+                for(size_t i = 0; i < neighborsIn[v].size(); ++i) {
+                    setEdgeAt<false>(inBegin[v] + i, neighborsIn[v][i]);
                 }
             });
-#if GROUP_EDGES
-        outBegin.push_back(outEdges.size());
-        inBegin.push_back(inEdges.size());
-#else
-        outBegin.push_back(outNeighbor.size());
-        inBegin.push_back(inNeighbor.size());
-#endif
 
         neighborsOut.clear();
         neighborsIn.clear();
+        finishOffsets();
+    }
+
+    // Builds the consecutive adjacency arrays directly from a ranked
+    // construction graph whose edges are sorted by rank, renumbering vertex v
+    // to perm[v]. The adjacency lists of g are released as soon as they have
+    // been copied, so g and this graph never both hold all edges.
+    template<typename G>
+    void buildConsecutive(G &g, std::vector<NODE_T> &perm) {
+        if(g.getNumberOfNodes() != n || perm.size() != n) {
+            std::cout << "Error! given order has wrong size!" << std::endl;
+            exit(1);
+        }
+        vector<vector<edgeInfo>>().swap(neighborsOut);
+        vector<vector<edgeInfo>>().swap(neighborsIn);
+
+        m = g.getNumberOfEdges();
+        outBegin.assign(n + 1, 0);
+        inBegin.assign(n + 1, 0);
+        g.forAllNodes([&] (NODE_T v) {
+                outBegin[perm[v] + 1] = g.getOutDegree(v);
+                inBegin[perm[v] + 1] = g.getInDegree(v);
+            });
+        setBeginFromDegrees();
+
+        resizeEdges(m);
+
+        NODE_T currentNode = NODE_INVALID;
+        size_t position = 0;
+        g.forAllEdgesOutAndRelease([&] (NODE_T u, NODE_T v, EDGEWEIGHT_T weight, EDGERANK_T rank) {
+                if(u != currentNode) {
+                    currentNode = u;
+                    position = outBegin[perm[u]];
+                }
+                setEdgeAt<true>(position, {perm[v], weight, rank});
+                ++position;
+            });
+
+        currentNode = NODE_INVALID;
+        g.forAllEdgesInAndRelease([&] (NODE_T v, NODE_T u, EDGEWEIGHT_T weight, EDGERANK_T rank) {
+                if(v != currentNode) {
+                    currentNode = v;
+                    position = inBegin[perm[v]];
+                }
+                setEdgeAt<false>(position, {perm[u], weight, rank});
+                ++position;
+            });
+
+        edgesSorted = true;
+        finishOffsets();
+        setNodeMap(perm);
+    }
+
+    // Builds the consecutive adjacency arrays from the graph g, renumbering
+    // vertex v to perm[v]. Unlike buildConsecutive, g is left untouched and
+    // need not be sorted: the degrees are counted and the adjacency ranges of
+    // the vertices filled and sorted by rank in parallel.
+    template<typename G>
+    void buildPermuted(G &g, const std::vector<NODE_T> &perm, unsigned numThreads) {
+        if(g.getNumberOfNodes() != n || perm.size() != n) {
+            std::cout << "Error! given order has wrong size!" << std::endl;
+            exit(1);
+        }
+        std::vector<NODE_T> original = g.getInversePermutation(perm);
+        vector<vector<edgeInfo>>().swap(neighborsOut);
+        vector<vector<edgeInfo>>().swap(neighborsIn);
+
+        m = g.getNumberOfEdges();
+        outBegin.assign(n + 1, 0);
+        inBegin.assign(n + 1, 0);
+        parallelFor(0, n, numThreads, [&] (NODE_T v) {
+                outBegin[perm[v] + 1] = g.getOutDegree(v);
+                inBegin[perm[v] + 1] = g.getInDegree(v);
+            });
+        setBeginFromDegrees(numThreads);
+
+        resizeEdges(m);
+
+        auto byRank = [] (const edgeInfo &i, const edgeInfo &j) {
+            return i.rank > j.rank;
+        };
+        parallelFor(0, n, numThreads, [&] (NODE_T newV) {
+                const NODE_T v = original[newV];
+                std::vector<edgeInfo> nodeEdges;
+
+                nodeEdges.reserve(g.getOutDegree(v));
+                g.forAllNeighborsOutWithHighRank(v, 0, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                        nodeEdges.push_back({perm[w], weight, rank});
+                    });
+                std::stable_sort(nodeEdges.begin(), nodeEdges.end(), byRank);
+                for(size_t i = 0; i < nodeEdges.size(); ++i) {
+                    setEdgeAt<true>(outBegin[newV] + i, nodeEdges[i]);
+                }
+
+                if constexpr(!undirected) {
+                    nodeEdges.clear();
+                    g.forAllNeighborsInWithHighRank(v, 0, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                            nodeEdges.push_back({perm[w], weight, rank});
+                        });
+                    std::stable_sort(nodeEdges.begin(), nodeEdges.end(), byRank);
+                    for(size_t i = 0; i < nodeEdges.size(); ++i) {
+                        setEdgeAt<false>(inBegin[newV] + i, nodeEdges[i]);
+                    }
+                }
+            });
+
+        edgesSorted = true;
+        finishOffsets();
+        std::vector<NODE_T> newNodeMap = perm;
+        setNodeMap(newNodeMap);
     }
 
 /******************************************************************************/
 
 protected:
+    // Turns the degrees stored at outBegin[v + 1] and inBegin[v + 1] into
+    // the start of the adjacency ranges. In the interleaved layout, both
+    // ranges point into one array. Undirected graphs get empty incoming
+    // ranges. The prefix sums of the other layouts use numThreads threads.
+    void setBeginFromDegrees(unsigned numThreads = 1) {
+        if constexpr(undirected) {
+            for(NODE_T v = 0; v < n; ++v) {
+                if(outBegin[v + 1] != inBegin[v + 1]) {
+                    std::cout << "Error! Vertex " << v << " has different in and out degrees in an undirected query graph" << std::endl;
+                    exit(1);
+                }
+            }
+            std::fill(inBegin.begin(), inBegin.end(), 0);
+        }
+        if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            uint64_t position = 0;
+            for(NODE_T v = 0; v < n; ++v) {
+                const EDGECOUNT_T outDegree = outBegin[v + 1];
+                const EDGECOUNT_T inDegree = inBegin[v + 1];
+                outBegin[v] = position;
+                inBegin[v] = position + outDegree;
+                position += outDegree + inDegree;
+            }
+            if(position > std::numeric_limits<EDGECOUNT_T>::max()) {
+                std::cout << "Error! " << position << " interleaved edges do not fit into EDGECOUNT_T" << std::endl;
+                exit(1);
+            }
+            outBegin[n] = position;
+            inBegin[n] = position;
+        }
+        else {
+            parallelPrefixSum(outBegin, numThreads);
+            parallelPrefixSum(inBegin, numThreads);
+        }
+    }
+
+    // Moves the adjacency ranges into the node summaries, or for the
+    // interleaved layout into one offset record per vertex. The compressed
+    // layout encodes the edges here.
+    void finishOffsets() {
+        if constexpr(layout == EDGE_LAYOUT_COMPRESSED) {
+            compressEdges<true>();
+            compressEdges<false>();
+        }
+        else if constexpr(useNodeSummaries) {
+            summaries.resize(n);
+            for(NODE_T v = 0; v < n; ++v) {
+                const EDGECOUNT_T outEnd = layout == EDGE_LAYOUT_INTERLEAVED ? inBegin[v] : outBegin[v + 1];
+                const EDGECOUNT_T inEnd = layout == EDGE_LAYOUT_INTERLEAVED ? outBegin[v + 1] : inBegin[v + 1];
+                nodeSummary &summary = summaries[v];
+                summary.outBegin = outBegin[v];
+                summary.outDegree = outEnd - outBegin[v];
+                summary.outMaxRank = summary.outDegree > 0 ? getRankAt<true>(outBegin[v]) : 0;
+                summary.inBegin = inBegin[v];
+                summary.inDegree = inEnd - inBegin[v];
+                summary.inMaxRank = summary.inDegree > 0 ? getRankAt<false>(inBegin[v]) : 0;
+            }
+            vector<EDGECOUNT_T>().swap(outBegin);
+            vector<EDGECOUNT_T>().swap(inBegin);
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            offsets.resize(n + 1);
+            for(NODE_T v = 0; v <= n; ++v) {
+                offsets[v] = {outBegin[v], inBegin[v]};
+            }
+            vector<EDGECOUNT_T>().swap(outBegin);
+            vector<EDGECOUNT_T>().swap(inBegin);
+        }
+    }
+
+    // Encodes each adjacency range as a byte stream of (rank, neighbor,
+    // weight) varints and releases the uncompressed edges. The first rank of
+    // a range is stored as is, every further rank as the difference to its
+    // predecessor, which is small as the ranks are sorted in descending
+    // order. Neighbors are stored relative to the vertex itself, which is
+    // cheap after a DFS order.
+    template<bool out>
+    void compressEdges() {
+        vector<edgeInfo> &uncompressed = out ? outEdges : inEdges;
+        vector<uint64_t> &byteBegin = out ? outByteBegin : inByteBegin;
+        vector<uint8_t> &bytes = out ? outBytes : inBytes;
+        byteBegin.assign(n + 1, 0);
+        bytes.clear();
+        for(NODE_T v = 0; v < n; ++v) {
+            byteBegin[v] = bytes.size();
+            const size_t begin = getBegin<out>(v);
+            for(size_t i = begin; i < getEnd<out>(v); ++i) {
+                const edgeInfo &edge = uncompressed[i];
+                appendVarint(bytes, i == begin ? edge.rank : uncompressed[i - 1].rank - edge.rank);
+                appendVarint(bytes, zigzagEncode(int64_t(edge.neighbor) - int64_t(v)));
+                appendVarint(bytes, edge.weight);
+            }
+        }
+        byteBegin[n] = bytes.size();
+        bytes.shrink_to_fit();
+        vector<edgeInfo>().swap(uncompressed);
+    }
+
+    // Decodes up to numEdges edges of v in order and passes them to
+    // callback(neighbor, rank, weight) until it returns true. The scan ends
+    // at the first edge with a rank below rankThreshold before its neighbor
+    // and weight are decoded.
+    template<bool out, typename F>
+    void forAllCompressedEdges(const NODE_T v, size_t numEdges, const EDGERANK_T rankThreshold, F &&callback) {
+        const uint8_t *position = (out ? outBytes : inBytes).data() + (out ? outByteBegin : inByteBegin)[v];
+        EDGERANK_T rank = 0;
+        for(size_t i = 0; i < numEdges; ++i) {
+            const EDGERANK_T rankCode = readVarint(position);
+            rank = i == 0 ? rankCode : rank - rankCode;
+            if(rank < rankThreshold) {
+                return;
+            }
+            const NODE_T neighbor = int64_t(v) + zigzagDecode(readVarint(position));
+            const EDGEWEIGHT_T weight = readVarint(position);
+            if(callback(neighbor, rank, weight)) {
+                return;
+            }
+        }
+    }
+
+    template<bool out>
+    size_t getBegin(const NODE_T v) {
+        if constexpr(useNodeSummaries) {
+            return out ? summaries[v].outBegin : summaries[v].inBegin;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            return out ? offsets[v].outBegin : offsets[v].inBegin;
+        }
+        else {
+            return (out ? outBegin : inBegin)[v];
+        }
+    }
+
+    template<bool out>
+    size_t getEnd(const NODE_T v) {
+        if constexpr(useNodeSummaries) {
+            return out ? summaries[v].outBegin + summaries[v].outDegree : summaries[v].inBegin + summaries[v].inDegree;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            return out ? offsets[v].inBegin : offsets[v + 1].outBegin;
+        }
+        else {
+            return (out ? outBegin : inBegin)[v + 1];
+        }
+    }
+
+    template<bool out>
+    NODE_T getNeighborAt(const size_t i) {
+        if constexpr(layout == EDGE_LAYOUT_GROUPED || layout == EDGE_LAYOUT_COMPRESSED) {
+            return (out ? outEdges : inEdges)[i].neighbor;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            return edges[i].neighbor;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_SPLIT) {
+            return (out ? outNeighbor : inNeighbor)[i];
+        }
+        else if constexpr(isPacked) {
+            return (out ? outPacked : inPacked)[i].neighbor;
+        }
+        else {
+            return (out ? outTargets : inTargets)[i].neighbor;
+        }
+    }
+
+    template<bool out>
+    EDGEWEIGHT_T getWeightAt(const size_t i) {
+        if constexpr(layout == EDGE_LAYOUT_GROUPED || layout == EDGE_LAYOUT_COMPRESSED) {
+            return (out ? outEdges : inEdges)[i].weight;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            return edges[i].weight;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_SPLIT) {
+            return (out ? outWeight : inWeight)[i];
+        }
+        else if constexpr(isPacked) {
+            return (out ? outPacked : inPacked)[i].weightAndRank & packedWeightMask;
+        }
+        else {
+            return (out ? outTargets : inTargets)[i].weight;
+        }
+    }
+
+    template<bool out>
+    EDGERANK_T getRankAt(const size_t i) {
+        if constexpr(layout == EDGE_LAYOUT_GROUPED || layout == EDGE_LAYOUT_COMPRESSED) {
+            return (out ? outEdges : inEdges)[i].rank;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            return edges[i].rank;
+        }
+        else if constexpr(isPacked) {
+            return (out ? outPacked : inPacked)[i].weightAndRank >> packedWeightBits;
+        }
+        else {
+            return (out ? outRank : inRank)[i];
+        }
+    }
+
+    template<bool out>
+    void setEdgeAt(const size_t i, const edgeInfo &edge) {
+        if constexpr(undirected && !out) {
+            // Already stored as an outgoing edge
+            return;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_GROUPED || layout == EDGE_LAYOUT_COMPRESSED) {
+            (out ? outEdges : inEdges)[i] = edge;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            edges[i] = edge;
+        }
+        else if constexpr(layout == EDGE_LAYOUT_SPLIT) {
+            (out ? outNeighbor : inNeighbor)[i] = edge.neighbor;
+            (out ? outWeight : inWeight)[i] = edge.weight;
+            (out ? outRank : inRank)[i] = edge.rank;
+        }
+        else if constexpr(isPacked) {
+            if(edge.weight > packedWeightMask || edge.rank > packedMaxRank) {
+                std::cout << "Error! Edge with weight " << edge.weight << " and rank " << edge.rank << " does not fit into the " << edgeLayoutNames[layout] << " layout" << std::endl;
+                exit(1);
+            }
+            (out ? outPacked : inPacked)[i] = {edge.neighbor, uint32_t(edge.weight | (uint32_t(edge.rank) << packedWeightBits))};
+        }
+        else {
+            (out ? outTargets : inTargets)[i] = {edge.neighbor, edge.weight};
+            (out ? outRank : inRank)[i] = edge.rank;
+        }
+    }
+
+    void resizeEdges(const EDGECOUNT_T numOutEdges) {
+        const EDGECOUNT_T numInEdges = undirected ? 0 : numOutEdges;
+        if constexpr(layout == EDGE_LAYOUT_GROUPED || layout == EDGE_LAYOUT_COMPRESSED) {
+            // The compressed layout fills these and encodes them in
+            // finishOffsets
+            outEdges.resize(numOutEdges);
+            inEdges.resize(numInEdges);
+        }
+        else if constexpr(layout == EDGE_LAYOUT_INTERLEAVED) {
+            edges.resize(size_t(numOutEdges) + numInEdges);
+        }
+        else if constexpr(layout == EDGE_LAYOUT_SPLIT) {
+            outNeighbor.resize(numOutEdges);
+            inNeighbor.resize(numInEdges);
+            outWeight.resize(numOutEdges);
+            inWeight.resize(numInEdges);
+            outRank.resize(numOutEdges);
+            inRank.resize(numInEdges);
+        }
+        else if constexpr(isPacked) {
+            outPacked.resize(numOutEdges);
+            inPacked.resize(numInEdges);
+        }
+        else {
+            outTargets.resize(numOutEdges);
+            inTargets.resize(numInEdges);
+            outRank.resize(numOutEdges);
+            inRank.resize(numInEdges);
+        }
+    }
+
+    template<bool out>
+    neighborWeightRange getNeighborRange(const NODE_T v, int percent) {
+        static_assert(hasNeighborRanges, "The edges of this layout can only be scanned, see forAllNeighborsInAndStopPartial");
+        const size_t begin = getBegin<out>(v);
+        const size_t size = ((getEnd<out>(v) - begin) * percent) / 100;
+        if(size == 0) {
+            return {nullptr, nullptr, 1, 1, 0};
+        }
+        if constexpr(isPacked) {
+            // The weights are read as the whole of weightAndRank and masked
+            const packedEdgeInfo &first = (out ? outPacked : inPacked)[begin];
+            return {&first.neighbor, reinterpret_cast<const EDGEWEIGHT_T *>(&first.weightAndRank), sizeof(packedEdgeInfo) / sizeof(NODE_T), sizeof(packedEdgeInfo) / sizeof(EDGEWEIGHT_T), size, EDGEWEIGHT_T(packedWeightMask)};
+        }
+        else if constexpr(layout == EDGE_LAYOUT_GROUPED || layout == EDGE_LAYOUT_INTERLEAVED) {
+            const edgeInfo &first = layout == EDGE_LAYOUT_GROUPED ? (out ? outEdges : inEdges)[begin] : edges[begin];
+            return {&first.neighbor, &first.weight, sizeof(edgeInfo) / sizeof(NODE_T), sizeof(edgeInfo) / sizeof(EDGEWEIGHT_T), size};
+        }
+        else if constexpr(layout == EDGE_LAYOUT_SPLIT) {
+            return {&(out ? outNeighbor : inNeighbor)[begin], &(out ? outWeight : inWeight)[begin], 1, 1, size};
+        }
+        else {
+            const neighborWeight &first = (out ? outTargets : inTargets)[begin];
+            return {&first.neighbor, &first.weight, sizeof(neighborWeight) / sizeof(NODE_T), sizeof(neighborWeight) / sizeof(EDGEWEIGHT_T), size};
+        }
+    }
+
+    template<bool out, typename F>
+    void forAllNeighborsAndStopPartial(const NODE_T v, F &callback, int percent) {
+        const size_t begin = getBegin<out>(v);
+        const size_t end = begin + (((getEnd<out>(v) - begin) * percent)/100);
+        if constexpr(layout == EDGE_LAYOUT_COMPRESSED) {
+            forAllCompressedEdges<out>(v, end - begin, 0, [&] (NODE_T neighbor, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    return callback(neighbor, weight);
+                });
+            return;
+        }
+        for(size_t i = begin; i < end; ++i) {
+            bool stop = callback(getNeighborAt<out>(i), getWeightAt<out>(i));
+            if(stop) {
+                return;
+            }
+        }
+    }
+
+    template<bool out, typename F>
+    void forAllNeighborsAndStop(const NODE_T v, F &callback) {
+        const size_t end = getEnd<out>(v);
+        if constexpr(layout == EDGE_LAYOUT_COMPRESSED) {
+            forAllCompressedEdges<out>(v, end - getBegin<out>(v), 0, [&] (NODE_T neighbor, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    return callback(neighbor, weight);
+                });
+            return;
+        }
+        for(size_t i = getBegin<out>(v); i < end; ++i) {
+            bool stop = callback(getNeighborAt<out>(i), getWeightAt<out>(i));
+            if(stop) {
+                return;
+            }
+        }
+    }
+
+    template<bool out, typename F>
+    void forAllNeighborsWithRank(const NODE_T v, F &callback) {
+        const size_t end = getEnd<out>(v);
+        if constexpr(layout == EDGE_LAYOUT_COMPRESSED) {
+            forAllCompressedEdges<out>(v, end - getBegin<out>(v), 0, [&] (NODE_T neighbor, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    callback(neighbor, rank, weight);
+                    return false;
+                });
+            return;
+        }
+        for(size_t i = getBegin<out>(v); i < end; ++i) {
+            callback(getNeighborAt<out>(i), getRankAt<out>(i), getWeightAt<out>(i));
+        }
+    }
+
+    template<bool out, typename F>
+    void forAllNeighborsWithHighRank(const NODE_T v, const EDGERANK_T rankThreshold, F &callback) {
+        size_t i, end;
+        if constexpr(useNodeSummaries) {
+            const nodeSummary &summary = summaries[v];
+            if((out ? summary.outMaxRank : summary.inMaxRank) < rankThreshold) {
+                return;
+            }
+            i = out ? summary.outBegin : summary.inBegin;
+            end = i + (out ? summary.outDegree : summary.inDegree);
+        }
+        else {
+            i = getBegin<out>(v);
+            end = getEnd<out>(v);
+        }
+        if constexpr(layout == EDGE_LAYOUT_COMPRESSED) {
+            forAllCompressedEdges<out>(v, end - i, rankThreshold, [&] (NODE_T neighbor, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    callback(neighbor, rank, weight);
+                    return false;
+                });
+        }
+        else if constexpr(layout == EDGE_LAYOUT_RANK_SPLIT) {
+            // Find the cutoff on the rank array alone and only then touch
+            // the neighbors and weights
+            const size_t cutoff = findRankCutoff((out ? outRank : inRank).data(), i, end, rankThreshold);
+            for(; i < cutoff; ++i) {
+                callback(getNeighborAt<out>(i), getRankAt<out>(i), getWeightAt<out>(i));
+            }
+        }
+        else {
+            while(i < end && getRankAt<out>(i) >= rankThreshold) {
+                callback(getNeighborAt<out>(i), getRankAt<out>(i), getWeightAt<out>(i));
+                ++i;
+            }
+        }
+    }
+
     NODE_T n;
     EDGECOUNT_T m;
     vector<vector<edgeInfo>> neighborsOut;
     vector<vector<edgeInfo>> neighborsIn;
     vector<EDGECOUNT_T> outBegin;
     vector<EDGECOUNT_T> inBegin;
-#if GROUP_EDGES
+    // Only the arrays of the chosen layout are used
     vector<edgeInfo> outEdges;
     vector<edgeInfo> inEdges;
-#else
     vector<NODE_T> outNeighbor;
     vector<NODE_T> inNeighbor;
     vector<EDGEWEIGHT_T> outWeight;
     vector<EDGEWEIGHT_T> inWeight;
     vector<EDGERANK_T> outRank;
     vector<EDGERANK_T> inRank;
-#endif
+    vector<neighborWeight> outTargets;
+    vector<neighborWeight> inTargets;
+    vector<nodeOffsets> offsets;
+    vector<nodeSummary> summaries;
+    vector<edgeInfo> edges;
+    vector<uint64_t> outByteBegin;
+    vector<uint64_t> inByteBegin;
+    vector<uint8_t> outBytes;
+    vector<uint8_t> inBytes;
+    vector<packedEdgeInfo> outPacked;
+    vector<packedEdgeInfo> inPacked;
+    vector<uint8_t> stallingPercentIn;
+    vector<uint8_t> stallingPercentOut;
+    vector<NODE_T> components;
     bool edgesSorted;
     vector<NODE_T> nodeMap;
     vector<NODE_T> reverseNodeMap;
 };
+
+typedef EdgeHierarchyGraphQueryOnlyLayout<GROUP_EDGES ? EDGE_LAYOUT_GROUPED : EDGE_LAYOUT_SPLIT> EdgeHierarchyGraphQueryOnly;
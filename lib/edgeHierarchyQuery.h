@@ -12,10 +12,10 @@
 #include <vector>
 #include <utility>
 
-#include "routingkit/id_queue.h"
 #include "routingkit/timestamp_flag.h"
 
 #include "definitions.h"
+#include "minIDHeap.h"
 #include "edgeHierarchyGraph.h"
 
 #define LOG_VERTICES_SETTLED false
@@ -37,6 +37,7 @@ public:
                                                 tentativeDistanceBackward(g.getNumberOfNodes()),
                                                 rankForward(g.getNumberOfNodes()),
                                                 rankBackward(g.getNumberOfNodes()) {
+        checkRoutingKitLimits(g.getNumberOfNodes(), "EdgeHierarchyQuery");
         numVerticesSettled = 0;
         numEdgesRelaxed = 0;
     };
@@ -154,7 +155,7 @@ protected:
 
     template<bool forward>
     void makeStep(NODE_T &shortestPathMeetingNode, EDGEWEIGHT_T &shortestPathLength) {
-        RoutingKit::MinIDQueue &PQCurrent = forward ? PQForward : PQBackward;
+        MinIDHeap<NODE_T, EDGEWEIGHT_T> &PQCurrent = forward ? PQForward : PQBackward;
         RoutingKit::TimestampFlags &wasPushedCurrent = forward ? wasPushedForward : wasPushedBackward;
         RoutingKit::TimestampFlags &wasPushedOther = forward ? wasPushedBackward : wasPushedForward;
         vector<EDGEWEIGHT_T> &tentativeDistanceCurrent = forward ? tentativeDistanceForward : tentativeDistanceBackward;
@@ -165,7 +166,7 @@ protected:
         numVerticesSettled++;
 
         NODE_T u = popped.id;
-        EDGERANK_T distanceU = popped.key;
+        EDGEWEIGHT_T distanceU = popped.key;
         assert(distanceU == tentativeDistanceCurrent[u]);
 
         // if(canStallAtNode<forward>(u)) {
@@ -192,7 +193,7 @@ protected:
             EDGEWEIGHT_T distanceV = distanceU + weight;
             if(wasPushedCurrent.is_set(v)) {
                 if(distanceV < tentativeDistanceCurrent[v]) {
-                    PQCurrent.decrease_key({v, distanceV});
+                    PQCurrent.decreaseKey({v, distanceV});
                     tentativeDistanceCurrent[v] = distanceV;
                     rankCurrent[v] = rank;
                 }
@@ -217,8 +218,8 @@ protected:
     }
 
     EdgeHierarchyGraph &g;
-    RoutingKit::MinIDQueue PQForward;
-    RoutingKit::MinIDQueue PQBackward;
+    MinIDHeap<NODE_T, EDGEWEIGHT_T> PQForward;
+    MinIDHeap<NODE_T, EDGEWEIGHT_T> PQBackward;
     RoutingKit::TimestampFlags wasPushedForward;
     RoutingKit::TimestampFlags wasPushedBackward;
     vector<EDGEWEIGHT_T> tentativeDistanceForward;
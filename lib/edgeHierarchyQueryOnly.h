@@ -11,15 +11,26 @@
 #include "assert.h"
 #include <vector>
 #include <utility>
+#include <algorithm>
 
-#include "routingkit/id_queue.h"
 #include "routingkit/timestamp_flag.h"
 
 #include "definitions.h"
 #include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryState.h"
+#include "stallCandidates.h"
+#include "landmarks.h"
+
+// Result of an approximate query: the shortest distance is at least
+// distance - errorBound
+struct boundedDistance {
+    EDGEWEIGHT_T distance;
+    EDGEWEIGHT_T errorBound;
+};
 
-
-template <bool stallForward, bool stallBackward, bool partialStalling, bool logVerticesSettled>
+// QueryState holds the per vertex state of each search direction, see
+// edgeHierarchyQueryState.h
+template <bool stallForward, bool stallBackward, bool partialStalling, bool logVerticesSettled, class Graph = EdgeHierarchyGraphQueryOnly, class QueryState = SplitQueryState>
 class EdgeHierarchyQueryOnly {
 public:
     uint64_t numVerticesSettled;
@@ -30,16 +41,13 @@ public:
     // NODE_T numVerticesSettledThisQuery;
     std::vector<std::pair<NODE_T, EDGEWEIGHT_T>> verticesSettledForward;
     std::vector<std::pair<NODE_T, EDGEWEIGHT_T>> verticesSettledBackward;
+    // Backward stalling checks of the last query, if logStalls is set
+    std::vector<loggedStall> stallLogForward;
+    std::vector<loggedStall> stallLogBackward;
 
-    EdgeHierarchyQueryOnly(EdgeHierarchyGraphQueryOnly &g) : g(g),
-                                                             PQForward(g.getNumberOfNodes()),
-                                                             PQBackward(g.getNumberOfNodes()),
-                                                             wasPushedForward(g.getNumberOfNodes()),
-                                                             wasPushedBackward(g.getNumberOfNodes()),
-                                                             tentativeDistanceForward(g.getNumberOfNodes()),
-                                                             tentativeDistanceBackward(g.getNumberOfNodes()),
-                                                             rankForward(g.getNumberOfNodes()),
-                                                             rankBackward(g.getNumberOfNodes()),
+    EdgeHierarchyQueryOnly(Graph &g) : g(g),
+                                                             stateForward(g.getNumberOfNodes()),
+                                                             stateBackward(g.getNumberOfNodes()),
 
                                                              actualDistanceForward(stallForward ? g.getNumberOfNodes() : 0),
                                                              actualDistanceBackward(stallForward ? g.getNumberOfNodes() : 0),
@@ -49,8 +57,64 @@ public:
         numVerticesSettled = 0;
         numEdgesRelaxed = 0;
         numEdgesLookedAtForStalling = 0;
+        relaxBatchSize = 0;
+        stallCandidates = nullptr;
+        landmarks = nullptr;
+        approximationEpsilon = 0;
+        distanceLowerBound = EDGEWEIGHT_INFINITY;
+        logStalls = false;
+        useStallingBudgets = false;
     };
 
+    // With a batch size of k > 0, the edges of a settled vertex are first
+    // collected and the query state of the head of edge i + k is prefetched
+    // before edge i is relaxed. 0 relaxes every edge as soon as it is found.
+    void setRelaxBatchSize(unsigned batchSize) {
+        relaxBatchSize = batchSize;
+    }
+
+    // If set, backward stalling only checks the candidate lists instead of
+    // all edges, regardless of partial stalling
+    void setStallCandidates(const StallCandidates *candidates) {
+        stallCandidates = candidates;
+    }
+
+    // If set, a settled vertex is not relaxed if its distance plus the ALT
+    // lower bound to the other end of the query cannot beat the best path
+    // found so far
+    void setLandmarks(const Landmarks *queryLandmarks) {
+        landmarks = queryLandmarks;
+    }
+
+    // With epsilon > 0, each direction stops as soon as its queue minimum
+    // times 1 + epsilon is at least the best path found so far. The distance
+    // returned is then at most 1 + epsilon times the shortest one.
+    void setApproximationEpsilon(double epsilon) {
+        approximationEpsilon = epsilon;
+    }
+
+    // Lower bound on the shortest distance of the last query, equal to the
+    // distance it returned unless the query was approximate
+    EDGEWEIGHT_T getDistanceLowerBound() const {
+        return distanceLowerBound;
+    }
+
+    boundedDistance getBoundedDistance(NODE_T externalS, NODE_T externalT, float stallingPercent) {
+        const EDGEWEIGHT_T distance = getDistance(externalS, externalT, stallingPercent);
+        return {distance, EDGEWEIGHT_T(distance == EDGEWEIGHT_INFINITY ? 0 : distance - distanceLowerBound)};
+    }
+
+    void setLogStalls(bool log) {
+        logStalls = log;
+    }
+
+    // If set, partial backward stalling checks the per vertex percentage of
+    // edges stored in the graph instead of the global stallingPercent. Full
+    // backward stalling still checks all edges.
+    void setUseStallingBudgets(bool useBudgets) {
+        useStallingBudgets = useBudgets;
+    }
+
     void resetCounters() {
         numVerticesSettled = 0;
         numEdgesRelaxed = 0;
@@ -59,10 +123,10 @@ public:
 
     EDGEWEIGHT_T getDistance(NODE_T externalS, NODE_T externalT, float stallingPercent) {
         //numVerticesSettledThisQuery = 0;
-        NODE_T s = g.getInternalNodeNumber(externalS);
-        NODE_T t = g.getInternalNodeNumber(externalT);
-        wasPushedForward.reset_all();
-        wasPushedBackward.reset_all();
+        s = g.getInternalNodeNumber(externalS);
+        t = g.getInternalNodeNumber(externalT);
+        stateForward.reset();
+        stateBackward.reset();
         if constexpr(stallForward) {
                 actualDistanceSetForward.reset_all();
                 actualDistanceSetBackward.reset_all();
@@ -74,15 +138,18 @@ public:
             verticesSettledForward.clear();
             verticesSettledBackward.clear();
         }
+        if(logStalls) {
+            stallLogForward.clear();
+            stallLogBackward.clear();
+        }
 
-        PQForward.push({s, 0});
-        PQBackward.push({t, 0});
-        wasPushedForward.set(s);
-        wasPushedBackward.set(t);
-        tentativeDistanceForward[s] = 0;
-        tentativeDistanceBackward[t] = 0;
-        rankForward[s] = 0;
-        rankBackward[t] = 0;
+        if(!g.mayReach(s, t)) {
+            distanceLowerBound = EDGEWEIGHT_INFINITY;
+            return EDGEWEIGHT_INFINITY;
+        }
+
+        stateForward.push(s, 0, 0);
+        stateBackward.push(t, 0, 0);
 
         bool forward = true;
         bool finished = false;
@@ -92,18 +159,18 @@ public:
 
         while(!finished) {
             bool forwardFinished = false;
-            if(PQForward.empty()) {
+            if(stateForward.queueEmpty()) {
                 forwardFinished = true;
             }
-            else if(PQForward.peek().key >= shortestPathLength) {
+            else if(cannotImprove(stateForward.getMinDistance(), shortestPathLength)) {
                 forwardFinished = true;
             }
 
             bool backwardFinished = false;
-            if(PQBackward.empty()) {
+            if(stateBackward.queueEmpty()) {
                 backwardFinished = true;
             }
-            else if(PQBackward.peek().key >= shortestPathLength) {
+            else if(cannotImprove(stateBackward.getMinDistance(), shortestPathLength)) {
                 backwardFinished = true;
             }
 
@@ -130,103 +197,189 @@ public:
             //     finished = true;
             // }
         }
-        PQForward.clear();
-        PQBackward.clear();
+
+        // A shorter path would meet at a vertex that one direction has not
+        // settled yet
+        distanceLowerBound = shortestPathLength;
+        if(!stateForward.queueEmpty()) {
+            distanceLowerBound = std::min(distanceLowerBound, stateForward.getMinDistance());
+        }
+        if(!stateBackward.queueEmpty()) {
+            distanceLowerBound = std::min(distanceLowerBound, stateBackward.getMinDistance());
+        }
         return shortestPathLength;
     }
 
+    // Runs the search of one direction from the internal vertex v until its
+    // queue is empty and calls callback(u, distance) for every vertex it
+    // settles without stalling. These are the search spaces hub labels are
+    // built from.
+    template<bool forward, typename F>
+    void forAllVerticesInSearchSpace(NODE_T v, F &&callback) {
+        QueryState &state = forward ? stateForward : stateBackward;
+        stateForward.reset();
+        stateBackward.reset();
+        if constexpr(stallForward) {
+            actualDistanceSetForward.reset_all();
+            actualDistanceSetBackward.reset_all();
+        }
+        // There is no other end of the query to bound the distance to
+        const Landmarks *queryLandmarks = landmarks;
+        landmarks = nullptr;
+
+        state.push(v, 0, 0);
+        NODE_T meetingNode = NODE_INVALID;
+        EDGEWEIGHT_T length = EDGEWEIGHT_INFINITY;
+        while(!state.queueEmpty()) {
+            const NODE_T u = makeStep<forward>(meetingNode, length, -1);
+            if(u != NODE_INVALID) {
+                callback(u, state.getDistance(u));
+            }
+        }
+        landmarks = queryLandmarks;
+    }
+
 protected:
 
+    bool cannotImprove(const EDGEWEIGHT_T minDistance, const EDGEWEIGHT_T shortestPathLength) const {
+        if(approximationEpsilon > 0 && shortestPathLength != EDGEWEIGHT_INFINITY) {
+            return minDistance * (1 + approximationEpsilon) >= shortestPathLength;
+        }
+        return minDistance >= shortestPathLength;
+    }
+
     template<bool forward>
     bool canStallAtNodeBackward(const NODE_T v) {
-        const RoutingKit::TimestampFlags &wasPushedCurrent = forward ? wasPushedForward : wasPushedBackward;
-        const vector<EDGEWEIGHT_T> &tentativeDistanceCurrent = forward ? tentativeDistanceForward : tentativeDistanceBackward;
-
-        bool result = false;
-
-        auto stallCheckFunc = [&] (const NODE_T u, const EDGEWEIGHT_T weight) {
-            ++numEdgesLookedAtForStalling;
-            if(wasPushedCurrent.is_set(u)) {
-                EDGEWEIGHT_T distanceV = tentativeDistanceCurrent[u] + weight;
-                if(distanceV < tentativeDistanceCurrent[v]) {
-                    result = true;
-                    return true;
-                }
-            }
-            return false;
-        };
+        return canStallAtNodeBackwardPartial<forward>(v, 100);
+    }
 
-        if(forward) {
-            g.forAllNeighborsInAndStop(v, stallCheckFunc);
+    // Vertex v can be stalled if the query state of the current direction
+    // has a shorter path to v over one of the first percent percent of its
+    // edges in the opposite direction, or over one of its stall candidates
+    template<bool forward>
+    bool canStallAtNodeBackwardPartial(const NODE_T v, int percent) {
+        const QueryState &stateCurrent = forward ? stateForward : stateBackward;
+        if constexpr(partialStalling) {
+            if(stallCandidates == nullptr && useStallingBudgets) {
+                percent = forward ? g.getStallingPercentIn(v) : g.getStallingPercentOut(v);
+            }
+        }
+        neighborWeightRange range;
+        if(stallCandidates != nullptr) {
+            range = forward ? stallCandidates->getCandidatesIn(v) : stallCandidates->getCandidatesOut(v);
+        }
+        else if constexpr(Graph::hasNeighborRanges) {
+            range = forward ? g.getNeighborRangeIn(v, percent) : g.getNeighborRangeOut(v, percent);
         }
         else {
-            g.forAllNeighborsOutAndStop(v, stallCheckFunc);
+            return canStallAtNodeBackwardByScan<forward>(v, percent);
         }
-        return result;
+        const size_t position = stateCurrent.findShorterPath(range, stateCurrent.getDistance(v));
+        numEdgesLookedAtForStalling += std::min(position + 1, range.size);
+        if(logStalls) {
+            vector<loggedStall> &stallLogCurrent = forward ? stallLogForward : stallLogBackward;
+            if(position < range.size) {
+                stallLogCurrent.push_back({v, range.getNeighbor(position), range.getWeight(position), EDGECOUNT_T(position), EDGECOUNT_T(range.size)});
+            }
+            else {
+                stallLogCurrent.push_back({v, NODE_INVALID, 0, EDGECOUNT_T(range.size), EDGECOUNT_T(range.size)});
+            }
+        }
+        return position < range.size;
     }
 
+    // Same as canStallAtNodeBackwardPartial for graphs that cannot hand out
+    // neighbor ranges: the edges are scanned in place up to the first
+    // shorter path
     template<bool forward>
-    bool canStallAtNodeBackwardPartial(const NODE_T v, int percent) {
-        const RoutingKit::TimestampFlags &wasPushedCurrent = forward ? wasPushedForward : wasPushedBackward;
-        const vector<EDGEWEIGHT_T> &tentativeDistanceCurrent = forward ? tentativeDistanceForward : tentativeDistanceBackward;
-
-        bool result = false;
-
-        auto stallCheckFunc = [&] (const NODE_T u, const EDGEWEIGHT_T weight) {
-            ++numEdgesLookedAtForStalling;
-            if(wasPushedCurrent.is_set(u)) {
-                EDGEWEIGHT_T distanceV = tentativeDistanceCurrent[u] + weight;
-                if(distanceV < tentativeDistanceCurrent[v]) {
-                    result = true;
-                    return true;
-                }
+    bool canStallAtNodeBackwardByScan(const NODE_T v, int percent) {
+        const QueryState &stateCurrent = forward ? stateForward : stateBackward;
+        const EDGEWEIGHT_T distance = stateCurrent.getDistance(v);
+        NODE_T stallNeighbor = NODE_INVALID;
+        EDGEWEIGHT_T stallWeight = 0;
+        EDGECOUNT_T position = 0;
+        auto isShorterPath = [&] (const NODE_T u, const EDGEWEIGHT_T weight) {
+            if(stateCurrent.isPushed(u) && stateCurrent.getDistance(u) + weight < distance) {
+                stallNeighbor = u;
+                stallWeight = weight;
+                return true;
             }
+            ++position;
             return false;
         };
-
         if(forward) {
-            g.forAllNeighborsInAndStopPartial(v, stallCheckFunc, percent);
+            g.forAllNeighborsInAndStopPartial(v, isShorterPath, percent);
         }
         else {
-            g.forAllNeighborsOutAndStopPartial(v, stallCheckFunc, percent);
+            g.forAllNeighborsOutAndStopPartial(v, isShorterPath, percent);
+        }
+        const bool canStall = stallNeighbor != NODE_INVALID;
+        numEdgesLookedAtForStalling += position + canStall;
+        if(logStalls) {
+            vector<loggedStall> &stallLogCurrent = forward ? stallLogForward : stallLogBackward;
+            const EDGECOUNT_T numEdges = ((forward ? g.getInDegree(v) : g.getOutDegree(v)) * percent) / 100;
+            stallLogCurrent.push_back({v, stallNeighbor, stallWeight, position, numEdges});
         }
-        return result;
+        return canStall;
     }
 
     template<bool forward>
     bool canStallAtNodeForward(NODE_T v) {
-        vector<EDGEWEIGHT_T> &tentativeDistanceCurrent = forward ? tentativeDistanceForward : tentativeDistanceBackward;
+        QueryState &stateCurrent = forward ? stateForward : stateBackward;
         vector<EDGEWEIGHT_T> &actualDistanceCurrent = forward ? actualDistanceForward : actualDistanceBackward;
         RoutingKit::TimestampFlags &actualDistanceSetCurrent = forward ? actualDistanceSetForward : actualDistanceSetBackward;
         if(actualDistanceSetCurrent.is_set(v)) {
-            return actualDistanceCurrent[v] < tentativeDistanceCurrent[v];
+            return actualDistanceCurrent[v] < stateCurrent.getDistance(v);
         } else {
             return false;
         }
     }
 
+    // Calls edgeFunc for all edges visited by forAllEdges, in batches if
+    // relaxBatchSize is set
+    template<bool forward, typename EdgeIterator, typename EdgeFunc>
+    void relaxEdges(EdgeIterator &&forAllEdges, EdgeFunc &&edgeFunc) {
+        if(relaxBatchSize == 0) {
+            forAllEdges(edgeFunc);
+            return;
+        }
+
+        const QueryState &stateCurrent = forward ? stateForward : stateBackward;
+        relaxBatch.clear();
+        forAllEdges([&] (const NODE_T v, const EDGERANK_T rank, const EDGEWEIGHT_T weight) {
+                relaxBatch.push_back({v, weight, rank});
+            });
+
+        const size_t numEdges = relaxBatch.size();
+        const size_t numAhead = std::min<size_t>(relaxBatchSize, numEdges);
+        for(size_t i = 0; i < numAhead; ++i) {
+            stateCurrent.prefetch(relaxBatch[i].neighbor);
+        }
+        for(size_t i = 0; i < numEdges; ++i) {
+            if(i + numAhead < numEdges) {
+                stateCurrent.prefetch(relaxBatch[i + numAhead].neighbor);
+            }
+            edgeFunc(relaxBatch[i].neighbor, relaxBatch[i].rank, relaxBatch[i].weight);
+        }
+    }
+
+    // Settles the next vertex of the given direction. Returns it, or
+    // NODE_INVALID if it was stalled or pruned instead of relaxed.
     template<bool forward>
-    void makeStep(NODE_T &shortestPathMeetingNode, EDGEWEIGHT_T &shortestPathLength, int stallingPercent) {
-        RoutingKit::MinIDQueue &PQCurrent = forward ? PQForward : PQBackward;
-        RoutingKit::TimestampFlags &wasPushedCurrent = forward ? wasPushedForward : wasPushedBackward;
-        RoutingKit::TimestampFlags &wasPushedOther = forward ? wasPushedBackward : wasPushedForward;
-        vector<EDGEWEIGHT_T> &tentativeDistanceCurrent = forward ? tentativeDistanceForward : tentativeDistanceBackward;
-        vector<EDGEWEIGHT_T> &tentativeDistanceOther = forward ? tentativeDistanceBackward : tentativeDistanceForward;
-        vector<EDGERANK_T> &rankCurrent = forward ? rankForward : rankBackward;
+    NODE_T makeStep(NODE_T &shortestPathMeetingNode, EDGEWEIGHT_T &shortestPathLength, int stallingPercent) {
+        QueryState &stateCurrent = forward ? stateForward : stateBackward;
+        QueryState &stateOther = forward ? stateBackward : stateForward;
         vector<EDGEWEIGHT_T> &actualDistanceCurrent = forward ? actualDistanceForward : actualDistanceBackward;
         RoutingKit::TimestampFlags &actualDistanceSetCurrent = forward ? actualDistanceSetForward : actualDistanceSetBackward;
 
-        const auto popped = PQCurrent.pop();
-
-        const NODE_T u = popped.id;
-        const EDGERANK_T distanceU = popped.key;
-        assert(distanceU == tentativeDistanceCurrent[u]);
+        const NODE_T u = stateCurrent.pop();
+        const EDGEWEIGHT_T distanceU = stateCurrent.getDistance(u);
 
         numVerticesSettled++;
 
         if constexpr(stallForward){
                 if(canStallAtNodeForward<forward>(u)) {
-                return;
+                return NODE_INVALID;
             }
         }
 
@@ -236,18 +389,18 @@ protected:
         //         int stallingPercentThisIteration = (1.0 * (avgSearchSpace - numVerticesSettledThisQuery))/avgSearchSpace * stallingPercent;
         //         stallingPercentThisIteration = std::clamp(stallingPercentThisIteration, 0, 100);
         //         if(canStallAtNodeBackwardPartial<forward>(u, stallingPercentThisIteration)) {
-        //             return;
+        //             return NODE_INVALID;
         //         }
         //     }
         if constexpr(stallBackward){
                 if constexpr(partialStalling) {
                     if(canStallAtNodeBackwardPartial<forward>(u, stallingPercent)) {
-                        return;
+                        return NODE_INVALID;
                     }
                 }
                 else {
                     if(canStallAtNodeBackward<forward>(u)) {
-                        return;
+                        return NODE_INVALID;
                     }
                 }
             }
@@ -261,41 +414,42 @@ protected:
             }
         }
 
-        if(wasPushedOther.is_set(u)){
-			if(shortestPathLength > distanceU + tentativeDistanceOther[u]){
-				shortestPathLength = distanceU + tentativeDistanceOther[u];
+        if(stateOther.isPushed(u)){
+			if(shortestPathLength > distanceU + stateOther.getDistance(u)){
+				shortestPathLength = distanceU + stateOther.getDistance(u);
 				shortestPathMeetingNode = u;
 			}
 		}
 
+        // distanceU < shortestPathLength, as the search stops otherwise
+        if(landmarks != nullptr) {
+            const EDGEWEIGHT_T lowerBound = forward ? landmarks->getLowerBound(u, t) : landmarks->getLowerBound(s, u);
+            if(lowerBound >= shortestPathLength - distanceU) {
+                return NODE_INVALID;
+            }
+        }
+
         auto relaxFunc = [&] (const NODE_T v, const EDGERANK_T rank, const EDGEWEIGHT_T weight) {
             ++numEdgesRelaxed;
             const EDGEWEIGHT_T distanceV = distanceU + weight;
-            if(wasPushedCurrent.is_set(v)) {
-                if(distanceV < tentativeDistanceCurrent[v]) {
+            if(stateCurrent.isPushed(v)) {
+                if(distanceV < stateCurrent.getDistance(v)) {
                     if constexpr(stallForward){
                         if(!actualDistanceSetCurrent.is_set(v) || distanceV < actualDistanceCurrent[v]) {
-                            PQCurrent.decrease_key({v, distanceV});
-                            tentativeDistanceCurrent[v] = distanceV;
-                            rankCurrent[v] = rank;
+                            stateCurrent.decreaseDistance(v, distanceV, rank);
                         }
                     }
                     else {
-                        PQCurrent.decrease_key({v, distanceV});
-                        tentativeDistanceCurrent[v] = distanceV;
-                        rankCurrent[v] = rank;
+                        stateCurrent.decreaseDistance(v, distanceV, rank);
                     }
 
                 }
-               else if(distanceV == tentativeDistanceCurrent[v] && rankCurrent[v] < rank) {
-                   rankCurrent[v] = rank;
+               else if(distanceV == stateCurrent.getDistance(v) && stateCurrent.getRank(v) < rank) {
+                   stateCurrent.setRank(v, rank);
                }
             }
             else {
-                PQCurrent.push({v, distanceV});
-                tentativeDistanceCurrent[v] = distanceV;
-                wasPushedCurrent.set(v);
-                rankCurrent[v] = rank;
+                stateCurrent.push(v, distanceV, rank);
             }
         };
 
@@ -303,8 +457,8 @@ protected:
             auto stallFunc = [&] (const NODE_T v, const EDGERANK_T rank, const EDGEWEIGHT_T weight) {
                 ++numEdgesLookedAtForStalling;
                 EDGEWEIGHT_T const distanceV = distanceU + weight;
-                if(wasPushedCurrent.is_set(v)) {
-                    if(tentativeDistanceCurrent[v] > distanceV) {
+                if(stateCurrent.isPushed(v)) {
+                    if(stateCurrent.getDistance(v) > distanceV) {
                         if(actualDistanceSetCurrent.is_set(v)) {
                             if(actualDistanceCurrent[v] > distanceV) {
                                 actualDistanceCurrent[v] = distanceV;
@@ -326,7 +480,7 @@ protected:
                 }
             };
 
-            EDGERANK_T rankU = rankCurrent[u];
+            EDGERANK_T rankU = stateCurrent.getRank(u);
             auto combinedFunc = [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
                 if(rank >= rankU) {
                     relaxFunc(v, rank, weight);
@@ -335,34 +489,51 @@ protected:
                 }
             };
 
-            if constexpr(forward) {
-                g.forAllNeighborsOutWithRank(u, combinedFunc);
-            }
-            else {
-                g.forAllNeighborsInWithRank(u, combinedFunc);
-            }
+            relaxEdges<forward>([&] (auto &&edgeFunc) {
+                    if constexpr(forward) {
+                        g.forAllNeighborsOutWithRank(u, edgeFunc);
+                    }
+                    else {
+                        g.forAllNeighborsInWithRank(u, edgeFunc);
+                    }
+                }, combinedFunc);
         }
         else {
-            if constexpr(forward) {
-                    g.forAllNeighborsOutWithHighRank(u, rankCurrent[u], relaxFunc);
-            }
-            else {
-                g.forAllNeighborsInWithHighRank(u, rankCurrent[u], relaxFunc);
-            }
+            const EDGERANK_T rankU = stateCurrent.getRank(u);
+            relaxEdges<forward>([&] (auto &&edgeFunc) {
+                    if constexpr(forward) {
+                        g.forAllNeighborsOutWithHighRank(u, rankU, edgeFunc);
+                    }
+                    else {
+                        g.forAllNeighborsInWithHighRank(u, rankU, edgeFunc);
+                    }
+                }, relaxFunc);
         }
+        return u;
     }
 
-    EdgeHierarchyGraphQueryOnly &g;
-    RoutingKit::MinIDQueue PQForward;
-    RoutingKit::MinIDQueue PQBackward;
-    RoutingKit::TimestampFlags wasPushedForward;
-    RoutingKit::TimestampFlags wasPushedBackward;
-    vector<EDGEWEIGHT_T> tentativeDistanceForward;
-    vector<EDGEWEIGHT_T> tentativeDistanceBackward;
-    vector<EDGERANK_T> rankForward;
-    vector<EDGERANK_T> rankBackward;
+    Graph &g;
+    QueryState stateForward;
+    QueryState stateBackward;
+    unsigned relaxBatchSize;
+    vector<edgeInfo> relaxBatch;
+    const StallCandidates *stallCandidates;
+    const Landmarks *landmarks;
+    double approximationEpsilon;
+    EDGEWEIGHT_T distanceLowerBound;
+    NODE_T s;
+    NODE_T t;
+    bool logStalls;
+    bool useStallingBudgets;
     vector<EDGEWEIGHT_T> actualDistanceForward;
     vector<EDGEWEIGHT_T> actualDistanceBackward;
     RoutingKit::TimestampFlags actualDistanceSetForward;
     RoutingKit::TimestampFlags actualDistanceSetBackward;
 };
+
+// Template template arguments of the benchmark take exactly five parameters
+template <bool stallForward, bool stallBackward, bool partialStalling, bool logVerticesSettled, class Graph>
+using EdgeHierarchyQueryOnlySplitState = EdgeHierarchyQueryOnly<stallForward, stallBackward, partialStalling, logVerticesSettled, Graph, SplitQueryState>;
+
+template <bool stallForward, bool stallBackward, bool partialStalling, bool logVerticesSettled, class Graph>
+using EdgeHierarchyQueryOnlyPackedState = EdgeHierarchyQueryOnly<stallForward, stallBackward, partialStalling, logVerticesSettled, Graph, PackedQueryState>;
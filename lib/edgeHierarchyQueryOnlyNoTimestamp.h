@@ -12,9 +12,8 @@
 #include <vector>
 #include <utility>
 
-#include "routingkit/id_queue.h"
-
 #include "definitions.h"
+#include "minIDHeap.h"
 #include "edgeHierarchyGraphQueryOnly.h"
 
 
@@ -64,6 +63,10 @@ public:
             verticesSettledBackward.clear();
         }
 
+        if(!g.mayReach(s, t)) {
+            return EDGEWEIGHT_INFINITY;
+        }
+
         PQForward.push({s, 0});
         PQBackward.push({t, 0});
         tentativeDistanceForward[s] = 0;
@@ -168,7 +171,7 @@ protected:
 
     template<bool forward>
     void makeStep(NODE_T &shortestPathMeetingNode, EDGEWEIGHT_T &shortestPathLength) {
-        RoutingKit::MinIDQueue &PQCurrent = forward ? PQForward : PQBackward;
+        MinIDHeap<NODE_T, EDGEWEIGHT_T> &PQCurrent = forward ? PQForward : PQBackward;
         vector<NODE_T> &visitedCurrent = forward ? visitedForward : visitedBackward;
         vector<EDGEWEIGHT_T> &tentativeDistanceCurrent = forward ? tentativeDistanceForward : tentativeDistanceBackward;
         vector<EDGEWEIGHT_T> &tentativeDistanceOther = forward ? tentativeDistanceBackward : tentativeDistanceForward;
@@ -177,7 +180,7 @@ protected:
         const auto popped = PQCurrent.pop();
 
         const NODE_T u = popped.id;
-        const EDGERANK_T distanceU = popped.key;
+        const EDGEWEIGHT_T distanceU = popped.key;
         assert(distanceU == tentativeDistanceCurrent[u]);
 
         numVerticesSettled++;
@@ -209,7 +212,7 @@ protected:
             const EDGEWEIGHT_T distanceV = distanceU + weight;
             if(tentativeDistanceCurrent[v] < EDGEWEIGHT_INFINITY) {
                 if(distanceV < tentativeDistanceCurrent[v]) {
-                    PQCurrent.decrease_key({v, distanceV});
+                    PQCurrent.decreaseKey({v, distanceV});
                     tentativeDistanceCurrent[v] = distanceV;
                     rankCurrent[v] = rank;
                 }
@@ -234,8 +237,8 @@ protected:
     }
 
     EdgeHierarchyGraphQueryOnly &g;
-    RoutingKit::MinIDQueue PQForward;
-    RoutingKit::MinIDQueue PQBackward;
+    MinIDHeap<NODE_T, EDGEWEIGHT_T> PQForward;
+    MinIDHeap<NODE_T, EDGEWEIGHT_T> PQBackward;
     vector<EDGEWEIGHT_T> tentativeDistanceForward;
     vector<EDGEWEIGHT_T> tentativeDistanceBackward;
     vector<EDGERANK_T> rankForward;
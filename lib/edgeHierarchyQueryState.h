@@ -0,0 +1,354 @@
+/*******************************************************************************
+ * lib/edgeHierarchyQueryState.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include "assert.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "routingkit/timestamp_flag.h"
+
+#include "definitions.h"
+#include "minIDHeap.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+
+using namespace std;
+
+// Returns the position of the first edge (u, v) in range, starting at begin,
+// where u was pushed and its distance plus the edge weight is less than
+// distance. Returns range.size if there is none.
+template<class QueryState>
+size_t findShorterPathScalar(const QueryState &state, const neighborWeightRange &range, size_t begin, const EDGEWEIGHT_T distance) {
+    for(size_t i = begin; i < range.size; ++i) {
+        const NODE_T u = range.getNeighbor(i);
+        if(state.isPushed(u) && state.getDistance(u) + range.getWeight(i) < distance) {
+            return i;
+        }
+    }
+    return range.size;
+}
+
+// Per vertex state of one search direction of an EH query: whether the vertex
+// was pushed in the current query, its tentative distance, the rank of the
+// edge it was reached by and the priority queue holding the pushed vertices.
+//
+// SplitQueryState keeps each of these in its own array, so relaxing an edge
+// touches up to four different cache lines.
+class SplitQueryState {
+public:
+    SplitQueryState(NODE_T n) : queue(n), wasPushed(n), tentativeDistance(n), rank(n) {
+        checkRoutingKitLimits(n, "SplitQueryState");
+    }
+
+    // Forgets all vertices pushed in the previous query
+    void reset() {
+        wasPushed.reset_all();
+        queue.clear();
+    }
+
+    bool isPushed(NODE_T v) const {
+        return wasPushed.is_set(v);
+    }
+
+    EDGEWEIGHT_T getDistance(NODE_T v) const {
+        return tentativeDistance[v];
+    }
+
+    EDGERANK_T getRank(NODE_T v) const {
+        return rank[v];
+    }
+
+    void setRank(NODE_T v, EDGERANK_T newRank) {
+        rank[v] = newRank;
+    }
+
+    // Hints that the state of v is needed soon. The timestamp flags are
+    // internal to RoutingKit and the heap positions to the queue, so they are
+    // not prefetched.
+    void prefetch(NODE_T v) const {
+        __builtin_prefetch(&tentativeDistance[v]);
+        __builtin_prefetch(&rank[v]);
+    }
+
+    // See findShorterPathScalar. Not vectorized since the timestamp flags
+    // cannot be gathered.
+    size_t findShorterPath(const neighborWeightRange &range, const EDGEWEIGHT_T distance) const {
+        return findShorterPathScalar(*this, range, 0, distance);
+    }
+
+    // v must not have been pushed in the current query
+    void push(NODE_T v, EDGEWEIGHT_T distance, EDGERANK_T newRank) {
+        queue.push({v, distance});
+        wasPushed.set(v);
+        tentativeDistance[v] = distance;
+        rank[v] = newRank;
+    }
+
+    // v must still be in the queue and distance must be smaller than its
+    // tentative distance
+    void decreaseDistance(NODE_T v, EDGEWEIGHT_T distance, EDGERANK_T newRank) {
+        queue.decreaseKey({v, distance});
+        tentativeDistance[v] = distance;
+        rank[v] = newRank;
+    }
+
+    bool queueEmpty() const {
+        return queue.empty();
+    }
+
+    EDGEWEIGHT_T getMinDistance() const {
+        return queue.peek().key;
+    }
+
+    // Removes the vertex with the smallest tentative distance from the queue
+    NODE_T pop() {
+        return queue.pop().id;
+    }
+
+protected:
+    MinIDHeap<NODE_T, EDGEWEIGHT_T> queue;
+    RoutingKit::TimestampFlags wasPushed;
+    vector<EDGEWEIGHT_T> tentativeDistance;
+    vector<EDGERANK_T> rank;
+};
+
+struct packedNodeState {
+    uint32_t timestamp;
+    EDGEWEIGHT_T distance;
+    EDGERANK_T rank;
+    uint32_t heapPosition;
+};
+
+static_assert(sizeof(packedNodeState) == 16 || sizeof(EDGEWEIGHT_T) != 4 || sizeof(EDGERANK_T) != 4, "packed query state records must fit four to a cache line");
+
+// Same interface as SplitQueryState, but all state of a vertex, including its
+// position in the priority queue, is packed into one 16 byte record, so
+// relaxing an edge touches a single cache line of per vertex state. The queue
+// is a 4-ary heap of (distance, vertex) pairs so that comparisons during sift
+// operations do not touch the records.
+class PackedQueryState {
+public:
+    PackedQueryState(NODE_T n) : states(n, {0, 0, 0, HEAP_POSITION_INVALID}), currentTimestamp(0) {
+    }
+
+    void reset() {
+        heap.clear();
+        ++currentTimestamp;
+        if(currentTimestamp == 0) {
+            // Timestamps wrapped around, so old records could look pushed
+            for(packedNodeState &state : states) {
+                state.timestamp = 0;
+            }
+            currentTimestamp = 1;
+        }
+    }
+
+    bool isPushed(NODE_T v) const {
+        return states[v].timestamp == currentTimestamp;
+    }
+
+    EDGEWEIGHT_T getDistance(NODE_T v) const {
+        return states[v].distance;
+    }
+
+    EDGERANK_T getRank(NODE_T v) const {
+        return states[v].rank;
+    }
+
+    void setRank(NODE_T v, EDGERANK_T newRank) {
+        states[v].rank = newRank;
+    }
+
+    void prefetch(NODE_T v) const {
+        __builtin_prefetch(&states[v]);
+    }
+
+    // See findShorterPathScalar. With AVX-512 or AVX2, the timestamps and
+    // distances of 16 or 8 neighbors are gathered at once. Neighbors that
+    // were not pushed get an infinite distance, so one unsigned comparison
+    // against distance minus the edge weight finds a shorter path.
+    size_t findShorterPath(const neighborWeightRange &range, const EDGEWEIGHT_T distance) const {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        if(VECTORIZED_STALLING && states.size() < MAX_GATHER_NODES) {
+            const __m512i distanceVector = _mm512_set1_epi32(distance);
+            const __m512i timestampVector = _mm512_set1_epi32(currentTimestamp);
+            const __m512i infinity = _mm512_set1_epi32(uint32_t(EDGEWEIGHT_INFINITY));
+            const __m512i zero = _mm512_setzero_si512();
+            const __m512i weightMask = _mm512_set1_epi32(range.weightMask);
+            const __m512i edgeOffsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(range.neighborStride));
+            for(; i + 16 <= range.size; i += 16) {
+                __m512i neighbors, weights;
+                if(range.neighborStride == 1) {
+                    neighbors = _mm512_loadu_si512(range.neighbors + i);
+                    weights = _mm512_loadu_si512(range.weights + i);
+                }
+                else {
+                    neighbors = _mm512_mask_i32gather_epi32(zero, 0xFFFF, edgeOffsets, range.neighbors + i * range.neighborStride, 4);
+                    weights = _mm512_mask_i32gather_epi32(zero, 0xFFFF, edgeOffsets, range.weights + i * range.neighborStride, 4);
+                }
+                weights = _mm512_and_si512(weights, weightMask);
+                // Records are 16 bytes, so neighbor * 2 in units of 8 bytes
+                const __m512i stateIndex = _mm512_add_epi32(neighbors, neighbors);
+                const __m512i timestamps = _mm512_mask_i32gather_epi32(zero, 0xFFFF, stateIndex, &states[0].timestamp, 8);
+                const __mmask16 isPushed = _mm512_cmpeq_epi32_mask(timestamps, timestampVector);
+                const __m512i distances = _mm512_mask_i32gather_epi32(infinity, isPushed, stateIndex, &states[0].distance, 8);
+                // distances < distance - weight, only where weight <= distance
+                const __mmask16 isNotTooLong = _mm512_cmple_epu32_mask(weights, distanceVector);
+                const __mmask16 isShorter = _mm512_mask_cmplt_epu32_mask(isNotTooLong, distances, _mm512_sub_epi32(distanceVector, weights));
+                if(isShorter != 0) {
+                    return i + __builtin_ctz(isShorter);
+                }
+            }
+        }
+#elif defined(__AVX2__)
+        if(VECTORIZED_STALLING && states.size() < MAX_GATHER_NODES) {
+            const __m256i distanceVector = _mm256_set1_epi32(distance);
+            const __m256i timestampVector = _mm256_set1_epi32(currentTimestamp);
+            const __m256i infinity = _mm256_set1_epi32(uint32_t(EDGEWEIGHT_INFINITY));
+            const __m256i weightMask = _mm256_set1_epi32(range.weightMask);
+            const __m256i edgeOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(range.neighborStride));
+            const int *timestampBase = reinterpret_cast<const int *>(&states[0].timestamp);
+            const int *distanceBase = reinterpret_cast<const int *>(&states[0].distance);
+            for(; i + 8 <= range.size; i += 8) {
+                __m256i neighbors, weights;
+                if(range.neighborStride == 1) {
+                    neighbors = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(range.neighbors + i));
+                    weights = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(range.weights + i));
+                }
+                else {
+                    neighbors = _mm256_i32gather_epi32(reinterpret_cast<const int *>(range.neighbors + i * range.neighborStride), edgeOffsets, 4);
+                    weights = _mm256_i32gather_epi32(reinterpret_cast<const int *>(range.weights + i * range.neighborStride), edgeOffsets, 4);
+                }
+                weights = _mm256_and_si256(weights, weightMask);
+                // Records are 16 bytes, so neighbor * 2 in units of 8 bytes
+                const __m256i stateIndex = _mm256_add_epi32(neighbors, neighbors);
+                const __m256i timestamps = _mm256_i32gather_epi32(timestampBase, stateIndex, 8);
+                const __m256i isPushed = _mm256_cmpeq_epi32(timestamps, timestampVector);
+                const __m256i distances = _mm256_mask_i32gather_epi32(infinity, distanceBase, stateIndex, isPushed, 8);
+                // distance - weight, or 0 if the weight alone is too long
+                const __m256i limit = _mm256_sub_epi32(_mm256_max_epu32(distanceVector, weights), weights);
+                // distances < limit iff max(distances, limit) != distances (unsigned)
+                const __m256i isNotShorter = _mm256_cmpeq_epi32(_mm256_max_epu32(distances, limit), distances);
+                const unsigned isShorter = ~_mm256_movemask_ps(_mm256_castsi256_ps(isNotShorter)) & 0xFF;
+                if(isShorter != 0) {
+                    return i + __builtin_ctz(isShorter);
+                }
+            }
+        }
+#endif
+        return findShorterPathScalar(*this, range, i, distance);
+    }
+
+    void push(NODE_T v, EDGEWEIGHT_T distance, EDGERANK_T newRank) {
+        assert(!isPushed(v));
+        states[v] = {currentTimestamp, distance, newRank, uint32_t(heap.size())};
+        heap.push_back({distance, v});
+        siftUp(heap.size() - 1);
+    }
+
+    void decreaseDistance(NODE_T v, EDGEWEIGHT_T distance, EDGERANK_T newRank) {
+        packedNodeState &state = states[v];
+        assert(isPushed(v) && distance < state.distance);
+        state.distance = distance;
+        state.rank = newRank;
+        if(state.heapPosition == HEAP_POSITION_INVALID) {
+            // Already popped, so it has to be settled again
+            state.heapPosition = heap.size();
+            heap.push_back({distance, v});
+        }
+        else {
+            heap[state.heapPosition].key = distance;
+        }
+        siftUp(state.heapPosition);
+    }
+
+    bool queueEmpty() const {
+        return heap.empty();
+    }
+
+    EDGEWEIGHT_T getMinDistance() const {
+        return heap[0].key;
+    }
+
+    NODE_T pop() {
+        const NODE_T v = heap[0].id;
+        states[v].heapPosition = HEAP_POSITION_INVALID;
+        const heapEntry last = heap.back();
+        heap.pop_back();
+        if(!heap.empty()) {
+            heap[0] = last;
+            states[last.id].heapPosition = 0;
+            siftDown(0);
+        }
+        return v;
+    }
+
+protected:
+    struct heapEntry {
+        EDGEWEIGHT_T key;
+        NODE_T id;
+    };
+
+    static constexpr uint32_t HEAP_POSITION_INVALID = numeric_limits<uint32_t>::max();
+    static constexpr size_t HEAP_ARITY = 4;
+    // Gather indices are signed 32 bit numbers of 8 byte units
+    static constexpr size_t MAX_GATHER_NODES = size_t(1) << 30;
+    // The vector code gathers 32 bit vertex IDs, weights and distances
+    static constexpr bool VECTORIZED_STALLING = sizeof(NODE_T) == 4 && sizeof(EDGEWEIGHT_T) == 4 && sizeof(packedNodeState) == 16;
+
+    void siftUp(size_t position) {
+        const heapEntry entry = heap[position];
+        while(position > 0) {
+            size_t parent = (position - 1) / HEAP_ARITY;
+            if(heap[parent].key <= entry.key) {
+                break;
+            }
+            heap[position] = heap[parent];
+            states[heap[position].id].heapPosition = position;
+            position = parent;
+        }
+        heap[position] = entry;
+        states[entry.id].heapPosition = position;
+    }
+
+    void siftDown(size_t position) {
+        const heapEntry entry = heap[position];
+        while(true) {
+            size_t firstChild = HEAP_ARITY * position + 1;
+            if(firstChild >= heap.size()) {
+                break;
+            }
+            size_t lastChild = std::min(firstChild + HEAP_ARITY, heap.size());
+            size_t minChild = firstChild;
+            for(size_t child = firstChild + 1; child < lastChild; ++child) {
+                if(heap[child].key < heap[minChild].key) {
+                    minChild = child;
+                }
+            }
+            if(heap[minChild].key >= entry.key) {
+                break;
+            }
+            heap[position] = heap[minChild];
+            states[heap[position].id].heapPosition = position;
+            position = minChild;
+        }
+        heap[position] = entry;
+        states[entry.id].heapPosition = position;
+    }
+
+    vector<packedNodeState> states;
+    vector<heapEntry> heap;
+    uint32_t currentTimestamp;
+};
@@ -19,24 +19,27 @@
 EdgeHierarchyGraph readEdgeHierarchy(string fileName) {
     std::ifstream infile(fileName);
 
-    NODE_T numVertices;
-    EDGEID_T numEdges;
+    uint64_t rawNumVertices, rawNumEdges;
     string line;
 
     getline(infile, line);
 
     istringstream iss(line);
 
-    iss >> numVertices >> numEdges;
+    iss >> rawNumVertices >> rawNumEdges;
+    NODE_T numVertices = checkedNarrow<NODE_T>(rawNumVertices, "Number of vertices", NODE_INVALID);
+    checkedNarrow<EDGECOUNT_T>(rawNumEdges, "Number of edges");
 
     EdgeHierarchyGraph g(numVertices);
 
     while (getline(infile, line)) {
         istringstream iss(line);
-        NODE_T u, v;
-        EDGEWEIGHT_T weight;
-        EDGERANK_T rank;
-        iss >> u >> v >> weight >> rank;
+        uint64_t rawU, rawV, rawWeight, rawRank;
+        iss >> rawU >> rawV >> rawWeight >> rawRank;
+        NODE_T u = checkedNarrow<NODE_T>(rawU, "Vertex ID", numVertices - 1);
+        NODE_T v = checkedNarrow<NODE_T>(rawV, "Vertex ID", numVertices - 1);
+        EDGEWEIGHT_T weight = checkedNarrow<EDGEWEIGHT_T>(rawWeight, "Edge weight", EDGEWEIGHT_INFINITY - 1);
+        EDGERANK_T rank = checkedNarrow<EDGERANK_T>(rawRank, "Edge rank");
         if(!g.hasEdge(u, v)) {
             g.addEdge(u, v, weight);
             g.setEdgeRank(u, v, rank);
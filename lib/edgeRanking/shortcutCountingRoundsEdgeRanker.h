@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <utility>
+#include <algorithm>
 #include "assert.h"
 
 #include "definitions.h"
@@ -25,16 +26,40 @@ using namespace std;
 class ShortcutCountingRoundsEdgeRanker {
 
 public:
-    ShortcutCountingRoundsEdgeRanker(EdgeHierarchyGraph &g) : g(g), query(g), mvc(g.getNumberOfNodes()), numShortcutEdges(g.getNumberOfEdges()), edgesInGraph(g.getNumberOfEdges()) {
+    ShortcutCountingRoundsEdgeRanker(EdgeHierarchyGraph &g) : ShortcutCountingRoundsEdgeRanker(g, vector<bool>(), vector<bool>()) {
+    }
+
+    // Only ranks edges (u, v) with rankableTail[u] and rankableHead[v]. Used
+    // to rank the interior of a partition independently of the other ones
+    ShortcutCountingRoundsEdgeRanker(EdgeHierarchyGraph &g, vector<bool> rankableTail, vector<bool> rankableHead) : ShortcutCountingRoundsEdgeRanker(g, rankableTail, rankableHead, false) {
+    }
+
+    // For EdgeHierarchyConstruction<ShortcutCountingRoundsEdgeRanker, true>:
+    // only hands out edges (u, v) with u < v and treats all edges incident
+    // to u or v as neighbors of (u, v)
+    ShortcutCountingRoundsEdgeRanker(EdgeHierarchyGraph &g, bool undirected) : ShortcutCountingRoundsEdgeRanker(g, vector<bool>(), vector<bool>(), undirected) {
+    }
+
+    ShortcutCountingRoundsEdgeRanker(EdgeHierarchyGraph &g, vector<bool> rankableTail, vector<bool> rankableHead, bool undirected) : g(g), query(g), mvc(g.getNumberOfNodes()), numShortcutEdges(std::max<EDGECOUNT_T>(g.getNumberOfEdges(), 1)), edgesInGraph(std::max<EDGECOUNT_T>(g.getNumberOfEdges(), 1)), rankableTail(rankableTail), rankableHead(rankableHead), undirected(undirected) {
         std::cout << "Shortcut counting rounds edge ranker" << std::endl;
         g.forAllNodes( [&] (NODE_T u) {
-                g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                g.forAllNeighborsOutWithHighRank(u, EDGERANK_INFINIY, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
                         addEdge(u, v);
                     });
             });
     }
 
+    bool isRankable(NODE_T u, NODE_T v) {
+        if(undirected && u > v) {
+            return false;
+        }
+        return rankableTail.empty() || (rankableTail[u] && rankableHead[v]);
+    }
+
     void addEdge(NODE_T u, NODE_T v) {
+        if(!isRankable(u, v)) {
+            return;
+        }
         EDGEID_T edgeId = edgeIdCreator.getEdgeId(u, v);
         if(edgesInGraph.capacity() <= edgeId) {
             edgesInGraph.resize(edgesInGraph.capacity() * 2);
@@ -96,8 +121,14 @@ protected:
             NODE_T v = edge.second;
             assert(g.getEdgeRank(u, v) == EDGERANK_INFINIY);
             g.setEdgeRank(u, v, EDGERANK_INFINIY - 1);
+            if(undirected) {
+                g.setEdgeRank(v, u, EDGERANK_INFINIY - 1);
+            }
             auto shortestPathsLost = getShortestPathsLost<false>(edge.first, edge.second, g.getEdgeWeight(u, v), g, query);
             g.setEdgeRank(u, v, EDGERANK_INFINIY);
+            if(undirected) {
+                g.setEdgeRank(v, u, EDGERANK_INFINIY);
+            }
             numShortcutEdges[edgeId] = mvc.getMinimumVertexCoverSize(shortestPathsLost.first);
         }
 
@@ -109,8 +140,32 @@ protected:
             NODE_T v = edge.second;
             EDGEID_T numShortcutEdgesCurrentEdge = numShortcutEdges[edgeId];
             bool isMinimum = true;
+            if(undirected) {
+                for(NODE_T endpoint : {u, v}) {
+                    g.forAllNeighborsOutWithHighRank(endpoint, EDGERANK_INFINIY,
+                                                     [&](NODE_T neighbor, EDGERANK_T level, EDGEWEIGHT_T weight) {
+                                                         const NODE_T tail = std::min(endpoint, neighbor);
+                                                         const NODE_T head = std::max(endpoint, neighbor);
+                                                         if((tail == u && head == v) || !isRankable(tail, head)) {
+                                                             return;
+                                                         }
+                                                         EDGEID_T incidentEdgeId = edgeIdCreator.getEdgeId(tail, head);
+                                                         assert(edgesInGraph.contains(incidentEdgeId));
+                                                         if (numShortcutEdges[incidentEdgeId] < numShortcutEdgesCurrentEdge) {
+                                                             isMinimum = false;
+                                                         }
+                                                     });
+                }
+                if(isMinimum) {
+                    currentRoundEdges.push_back(edgeId);
+                }
+                continue;
+            }
             g.forAllNeighborsOutWithHighRank(v, EDGERANK_INFINIY,
                                              [&](NODE_T neighbor, EDGERANK_T level, EDGEWEIGHT_T weight) {
+                                                 if(!isRankable(v, neighbor)) {
+                                                     return;
+                                                 }
                                                  EDGEID_T incidentEdgeId = edgeIdCreator.getEdgeId(v, neighbor);
                                                  assert(edgesInGraph.contains(incidentEdgeId));
                                                  if (numShortcutEdges[incidentEdgeId] < numShortcutEdgesCurrentEdge) {
@@ -121,6 +176,9 @@ protected:
             if(isMinimum) {
                 g.forAllNeighborsInWithHighRank(u, EDGERANK_INFINIY,
                                                 [&](NODE_T neighbor, EDGERANK_T level, EDGEWEIGHT_T weight) {
+                                                    if(!isRankable(neighbor, u)) {
+                                                        return;
+                                                    }
                                                     EDGEID_T incidentEdgeId = edgeIdCreator.getEdgeId(neighbor, u);
                                                     assert(edgesInGraph.contains(incidentEdgeId));
                                                     if (numShortcutEdges[incidentEdgeId] <
@@ -144,5 +202,8 @@ protected:
     vector<EDGEID_T> numShortcutEdges;
     ArraySet<EDGEID_T> edgesInGraph;
     vector<EDGEID_T> currentRoundEdges;
+    vector<bool> rankableTail;
+    vector<bool> rankableHead;
+    bool undirected;
     // vector<bool> needsUpdate;
 };
@@ -0,0 +1,331 @@
+/*******************************************************************************
+ * lib/hubLabels.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "definitions.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "parallelFor.h"
+
+using namespace std;
+
+// Returns the minimum of distancesA[i] + distancesB[j] over all i, j with
+// hubsA[i] == hubsB[j], given hubs sorted in ascending order. With AVX2,
+// blocks of eight hubs are compared against all rotations of the other
+// block, and only blocks sharing a hub are looked at one by one.
+inline EDGEWEIGHT_T getShortestDistanceOverCommonHubs(const NODE_T *hubsA, const EDGEWEIGHT_T *distancesA, size_t sizeA, const NODE_T *hubsB, const EDGEWEIGHT_T *distancesB, size_t sizeB) {
+    EDGEWEIGHT_T distance = EDGEWEIGHT_INFINITY;
+    size_t i = 0;
+    size_t j = 0;
+#ifdef __AVX2__
+    if constexpr(sizeof(NODE_T) == 4) {
+        const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+        while(i + 8 <= sizeA && j + 8 <= sizeB) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hubsA + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hubsB + j));
+            __m256i isCommon = _mm256_cmpeq_epi32(a, b);
+            for(unsigned r = 1; r < 8; ++r) {
+                b = _mm256_permutevar8x32_epi32(b, rotate);
+                isCommon = _mm256_or_si256(isCommon, _mm256_cmpeq_epi32(a, b));
+            }
+            unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(isCommon));
+            while(mask != 0) {
+                const size_t k = i + __builtin_ctz(mask);
+                mask &= mask - 1;
+                const size_t l = std::find(hubsB + j, hubsB + j + 8, hubsA[k]) - hubsB;
+                distance = std::min<EDGEWEIGHT_T>(distance, distancesA[k] + distancesB[l]);
+            }
+            const NODE_T lastA = hubsA[i + 7];
+            const NODE_T lastB = hubsB[j + 7];
+            if(lastA <= lastB) {
+                i += 8;
+            }
+            if(lastB <= lastA) {
+                j += 8;
+            }
+        }
+    }
+#endif
+    while(i < sizeA && j < sizeB) {
+        if(hubsA[i] < hubsB[j]) {
+            ++i;
+        }
+        else if(hubsA[i] > hubsB[j]) {
+            ++j;
+        }
+        else {
+            distance = std::min<EDGEWEIGHT_T>(distance, distancesA[i] + distancesB[j]);
+            ++i;
+            ++j;
+        }
+    }
+    return distance;
+}
+
+// Forward and backward hub labels of every vertex, taken from the search
+// spaces of the EH query. Labels are indexed by external vertex IDs, their
+// hubs are the internal IDs of the query graph they were built from. For
+// each direction, the hubs and distances of all labels are stored in one
+// array each, so that the labels can be written to a file and mapped back
+// into memory as they are.
+class HubLabels {
+public:
+    HubLabels() : n(0) {
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            firstEntry[direction] = nullptr;
+            hubs[direction] = nullptr;
+            distances[direction] = nullptr;
+            numEntries[direction] = 0;
+        }
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+
+    HubLabels(const HubLabels &) = delete;
+    HubLabels &operator=(const HubLabels &) = delete;
+
+    ~HubLabels() {
+        unmap();
+    }
+
+    // Runs the forward and backward search of every vertex using numThreads
+    // threads. Afterwards, bootstrapping removes every entry whose distance
+    // is longer than the distance the labels themselves give from the
+    // vertex to the hub: such an entry cannot be part of a shortest path.
+    template<class Graph>
+    void build(Graph &g, unsigned numThreads) {
+        unmap();
+        n = g.getNumberOfNodes();
+        numThreads = std::max(numThreads, 1u);
+        vector<vector<labelEntry>> labels[2];
+        labels[0].resize(n);
+        labels[1].resize(n);
+
+        std::atomic<size_t> nextVertex(0);
+        parallelFor(0, numThreads, numThreads, [&] (size_t thread) {
+                EdgeHierarchyQueryOnly<false, true, false, false, Graph, PackedQueryState> query(g);
+                for(size_t v = nextVertex++; v < n; v = nextVertex++) {
+                    query.template forAllVerticesInSearchSpace<true>(v, [&] (NODE_T hub, EDGEWEIGHT_T distance) {
+                            labels[0][v].push_back({hub, distance});
+                        });
+                    query.template forAllVerticesInSearchSpace<false>(v, [&] (NODE_T hub, EDGEWEIGHT_T distance) {
+                            labels[1][v].push_back({hub, distance});
+                        });
+                    for(unsigned direction = 0; direction < 2; ++direction) {
+                        std::sort(labels[direction][v].begin(), labels[direction][v].end(), [] (const labelEntry &a, const labelEntry &b) {
+                                return a.hub < b.hub;
+                            });
+                    }
+                }
+            }, 1);
+
+        vector<vector<labelEntry>> prunedLabels[2];
+        prunedLabels[0].resize(n);
+        prunedLabels[1].resize(n);
+        parallelFor(0, n, numThreads, [&] (size_t v) {
+                for(unsigned direction = 0; direction < 2; ++direction) {
+                    for(const labelEntry &entry : labels[direction][v]) {
+                        const vector<labelEntry> &hubLabel = labels[1 - direction][entry.hub];
+                        if(getShortestDistance(labels[direction][v], hubLabel) == entry.distance) {
+                            prunedLabels[direction][v].push_back(entry);
+                        }
+                    }
+                }
+            });
+
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            labels[direction].clear();
+            labels[direction].shrink_to_fit();
+            ownedFirstEntry[direction].assign(n + 1, 0);
+            for(NODE_T v = 0; v < n; ++v) {
+                ownedFirstEntry[direction][v + 1] = ownedFirstEntry[direction][v] + prunedLabels[direction][g.getInternalNodeNumber(v)].size();
+            }
+            ownedHubs[direction].resize(ownedFirstEntry[direction][n]);
+            ownedDistances[direction].resize(ownedFirstEntry[direction][n]);
+            for(NODE_T v = 0; v < n; ++v) {
+                size_t position = ownedFirstEntry[direction][v];
+                for(const labelEntry &entry : prunedLabels[direction][g.getInternalNodeNumber(v)]) {
+                    ownedHubs[direction][position] = entry.hub;
+                    ownedDistances[direction][position] = entry.distance;
+                    ++position;
+                }
+            }
+            firstEntry[direction] = ownedFirstEntry[direction].data();
+            hubs[direction] = ownedHubs[direction].data();
+            distances[direction] = ownedDistances[direction].data();
+            numEntries[direction] = ownedHubs[direction].size();
+        }
+    }
+
+    // Writes the header followed by the offsets, hubs and distances of the
+    // forward and then the backward labels, each padded to 8 bytes
+    void write(const string &fileName) const {
+        ofstream file(fileName, ios::binary);
+        if(!file) {
+            std::cout << "Error! Could not open " << fileName << " to write hub labels" << std::endl;
+            exit(1);
+        }
+        const uint64_t header[HEADER_WORDS] = {FILE_MAGIC, sizeof(NODE_T), sizeof(EDGEWEIGHT_T), n, numEntries[0], numEntries[1]};
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            writePadded(file, firstEntry[direction], (size_t(n) + 1) * sizeof(uint64_t));
+            writePadded(file, hubs[direction], numEntries[direction] * sizeof(NODE_T));
+            writePadded(file, distances[direction], numEntries[direction] * sizeof(EDGEWEIGHT_T));
+        }
+    }
+
+    // Maps a file written by write() into memory. The labels are only read
+    // from disk as queries touch them.
+    void readMapped(const string &fileName) {
+        unmap();
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if(fd < 0) {
+            std::cout << "Error! Could not open " << fileName << " to read hub labels" << std::endl;
+            exit(1);
+        }
+        struct stat fileStat;
+        fstat(fd, &fileStat);
+        mappingSize = fileStat.st_size;
+        void *mapped = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if(mapped == MAP_FAILED || mappingSize < HEADER_WORDS * sizeof(uint64_t)) {
+            std::cout << "Error! Could not map hub label file " << fileName << std::endl;
+            exit(1);
+        }
+        mapping = mapped;
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            ownedFirstEntry[direction] = vector<uint64_t>();
+            ownedHubs[direction] = vector<NODE_T>();
+            ownedDistances[direction] = vector<EDGEWEIGHT_T>();
+        }
+
+        const uint64_t *header = static_cast<const uint64_t *>(mapping);
+        if(header[0] != FILE_MAGIC || header[1] != sizeof(NODE_T) || header[2] != sizeof(EDGEWEIGHT_T)) {
+            std::cout << "Error! " << fileName << " is no hub label file of this build" << std::endl;
+            exit(1);
+        }
+        n = header[3];
+        const char *position = reinterpret_cast<const char *>(header + HEADER_WORDS);
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            numEntries[direction] = header[4 + direction];
+            firstEntry[direction] = reinterpret_cast<const uint64_t *>(position);
+            position += getPaddedSize((size_t(n) + 1) * sizeof(uint64_t));
+            hubs[direction] = reinterpret_cast<const NODE_T *>(position);
+            position += getPaddedSize(numEntries[direction] * sizeof(NODE_T));
+            distances[direction] = reinterpret_cast<const EDGEWEIGHT_T *>(position);
+            position += getPaddedSize(numEntries[direction] * sizeof(EDGEWEIGHT_T));
+        }
+        if(position > static_cast<const char *>(mapping) + mappingSize) {
+            std::cout << "Error! Hub label file " << fileName << " is truncated" << std::endl;
+            exit(1);
+        }
+    }
+
+    // Takes external vertex IDs
+    EDGEWEIGHT_T getDistance(NODE_T s, NODE_T t) const {
+        const uint64_t beginS = firstEntry[0][s];
+        const uint64_t beginT = firstEntry[1][t];
+        return getShortestDistanceOverCommonHubs(hubs[0] + beginS, distances[0] + beginS, firstEntry[0][s + 1] - beginS,
+                                                 hubs[1] + beginT, distances[1] + beginT, firstEntry[1][t + 1] - beginT);
+    }
+
+    NODE_T getNumberOfNodes() const {
+        return n;
+    }
+
+    size_t getNumberOfEntries(bool forward) const {
+        return numEntries[forward ? 0 : 1];
+    }
+
+    size_t getBytes() const {
+        size_t bytes = 0;
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            bytes += (size_t(n) + 1) * sizeof(uint64_t) + numEntries[direction] * (sizeof(NODE_T) + sizeof(EDGEWEIGHT_T));
+        }
+        return bytes;
+    }
+
+protected:
+    struct labelEntry {
+        NODE_T hub;
+        EDGEWEIGHT_T distance;
+    };
+
+    static constexpr uint64_t FILE_MAGIC = 0x4c42414c42554845; // "EHUBLABL"
+    static constexpr size_t HEADER_WORDS = 6;
+
+    static EDGEWEIGHT_T getShortestDistance(const vector<labelEntry> &a, const vector<labelEntry> &b) {
+        EDGEWEIGHT_T distance = EDGEWEIGHT_INFINITY;
+        size_t i = 0;
+        size_t j = 0;
+        while(i < a.size() && j < b.size()) {
+            if(a[i].hub < b[j].hub) {
+                ++i;
+            }
+            else if(a[i].hub > b[j].hub) {
+                ++j;
+            }
+            else {
+                distance = std::min<EDGEWEIGHT_T>(distance, a[i].distance + b[j].distance);
+                ++i;
+                ++j;
+            }
+        }
+        return distance;
+    }
+
+    static size_t getPaddedSize(size_t bytes) {
+        return (bytes + 7) & ~size_t(7);
+    }
+
+    static void writePadded(ofstream &file, const void *data, size_t bytes) {
+        file.write(static_cast<const char *>(data), bytes);
+        const char padding[8] = {0};
+        file.write(padding, getPaddedSize(bytes) - bytes);
+    }
+
+    void unmap() {
+        if(mapping != nullptr) {
+            munmap(mapping, mappingSize);
+            mapping = nullptr;
+            mappingSize = 0;
+        }
+    }
+
+    NODE_T n;
+    const uint64_t *firstEntry[2];
+    const NODE_T *hubs[2];
+    const EDGEWEIGHT_T *distances[2];
+    size_t numEntries[2];
+
+    // Backing arrays after build(), unused when the labels are mapped
+    vector<uint64_t> ownedFirstEntry[2];
+    vector<NODE_T> ownedHubs[2];
+    vector<EDGEWEIGHT_T> ownedDistances[2];
+
+    void *mapping;
+    size_t mappingSize;
+};
@@ -0,0 +1,228 @@
+/*******************************************************************************
+ * lib/landmarks.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <functional>
+
+#include "definitions.h"
+
+using namespace std;
+
+enum LandmarkSelection {
+    LANDMARKS_RANDOM = 0, // uniformly at random
+    LANDMARKS_FARTHEST,   // each landmark as far as possible from the previous ones
+    LANDMARKS_AVOID,      // leaves of shortest path trees the previous landmarks cover worst
+    NUM_LANDMARK_SELECTIONS
+};
+
+const char *const landmarkSelectionNames[NUM_LANDMARK_SELECTIONS] = {"random", "farthest", "avoid"};
+
+LandmarkSelection getLandmarkSelectionFromName(const string &name) {
+    for(unsigned selection = 0; selection < NUM_LANDMARK_SELECTIONS; ++selection) {
+        if(name == landmarkSelectionNames[selection]) {
+            return LandmarkSelection(selection);
+        }
+    }
+    std::cout << "Error! Unknown landmark selection " << name << std::endl;
+    exit(1);
+}
+
+// Distances from and to a few landmark vertices for ALT lower bounds. Uses
+// the internal vertex IDs of the query graph the landmarks are built for.
+// The query graph holds all edges of the EH, so Dijkstra on it ignoring the
+// ranks yields exact distances.
+class Landmarks {
+public:
+    template<class Graph>
+    Landmarks(Graph &g, unsigned numLandmarks, LandmarkSelection selection, unsigned seed) : n(g.getNumberOfNodes()), numLandmarks(std::min<NODE_T>(numLandmarks, g.getNumberOfNodes())) {
+        fromLandmark.resize(size_t(n) * this->numLandmarks);
+        toLandmark.resize(size_t(n) * this->numLandmarks);
+        std::default_random_engine gen(seed);
+        std::uniform_int_distribution<NODE_T> randomVertex(0, n == 0 ? 0 : n - 1);
+        vector<EDGEWEIGHT_T> distance;
+        vector<NODE_T> parent;
+        vector<NODE_T> settleOrder;
+
+        for(unsigned i = 0; i < this->numLandmarks; ++i) {
+            NODE_T landmark = randomVertex(gen);
+            if(selection == LANDMARKS_FARTHEST && i > 0) {
+                landmark = getFarthestVertex(i);
+            }
+            else if(selection == LANDMARKS_AVOID && i > 0) {
+                runDijkstra<true>(g, randomVertex(gen), distance, parent, settleOrder);
+                landmark = getAvoidVertex(i, distance, parent, settleOrder);
+            }
+            while(std::find(landmarks.begin(), landmarks.end(), landmark) != landmarks.end()) {
+                landmark = randomVertex(gen);
+            }
+            landmarks.push_back(landmark);
+
+            runDijkstra<true>(g, landmark, distance, parent, settleOrder);
+            for(NODE_T v = 0; v < n; ++v) {
+                fromLandmark[size_t(v) * this->numLandmarks + i] = distance[v];
+            }
+            runDijkstra<false>(g, landmark, distance, parent, settleOrder);
+            for(NODE_T v = 0; v < n; ++v) {
+                toLandmark[size_t(v) * this->numLandmarks + i] = distance[v];
+            }
+        }
+    }
+
+    // Lower bound on the distance from u to v by the triangle inequality,
+    // EDGEWEIGHT_INFINITY if a landmark shows that v cannot be reached
+    EDGEWEIGHT_T getLowerBound(NODE_T u, NODE_T v) const {
+        const EDGEWEIGHT_T *fromU = &fromLandmark[size_t(u) * numLandmarks];
+        const EDGEWEIGHT_T *fromV = &fromLandmark[size_t(v) * numLandmarks];
+        const EDGEWEIGHT_T *toU = &toLandmark[size_t(u) * numLandmarks];
+        const EDGEWEIGHT_T *toV = &toLandmark[size_t(v) * numLandmarks];
+        EDGEWEIGHT_T bound = 0;
+        for(NODE_T i = 0; i < numLandmarks; ++i) {
+            // d(L, v) <= d(L, u) + d(u, v)
+            if(fromU[i] != EDGEWEIGHT_INFINITY) {
+                if(fromV[i] == EDGEWEIGHT_INFINITY) {
+                    return EDGEWEIGHT_INFINITY;
+                }
+                if(fromV[i] > fromU[i]) {
+                    bound = std::max<EDGEWEIGHT_T>(bound, fromV[i] - fromU[i]);
+                }
+            }
+            // d(u, L) <= d(u, v) + d(v, L)
+            if(toV[i] != EDGEWEIGHT_INFINITY) {
+                if(toU[i] == EDGEWEIGHT_INFINITY) {
+                    return EDGEWEIGHT_INFINITY;
+                }
+                if(toU[i] > toV[i]) {
+                    bound = std::max<EDGEWEIGHT_T>(bound, toU[i] - toV[i]);
+                }
+            }
+        }
+        return bound;
+    }
+
+    const vector<NODE_T> &getLandmarks() const {
+        return landmarks;
+    }
+
+    size_t getBytes() const {
+        return (fromLandmark.size() + toLandmark.size()) * sizeof(EDGEWEIGHT_T);
+    }
+
+protected:
+    // Dijkstra from (forward) or to source over all edges of g
+    template<bool forward, class Graph>
+    void runDijkstra(Graph &g, NODE_T source, vector<EDGEWEIGHT_T> &distance, vector<NODE_T> &parent, vector<NODE_T> &settleOrder) {
+        distance.assign(n, EDGEWEIGHT_INFINITY);
+        parent.assign(n, NODE_INVALID);
+        settleOrder.clear();
+        priority_queue<pair<EDGEWEIGHT_T, NODE_T>, vector<pair<EDGEWEIGHT_T, NODE_T>>, greater<pair<EDGEWEIGHT_T, NODE_T>>> queue;
+        distance[source] = 0;
+        queue.push({0, source});
+        while(!queue.empty()) {
+            const auto [distanceU, u] = queue.top();
+            queue.pop();
+            if(distanceU > distance[u]) {
+                continue;
+            }
+            settleOrder.push_back(u);
+            auto relax = [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                if(distanceU + weight < distance[v]) {
+                    distance[v] = distanceU + weight;
+                    parent[v] = u;
+                    queue.push({distance[v], v});
+                }
+            };
+            if constexpr(forward) {
+                g.forAllNeighborsOutWithHighRank(u, 0, relax);
+            }
+            else {
+                g.forAllNeighborsInWithHighRank(u, 0, relax);
+            }
+        }
+    }
+
+    // Vertex with the largest distance from its closest landmark among the
+    // first numChosen ones, counting only vertices some landmark reaches
+    NODE_T getFarthestVertex(unsigned numChosen) {
+        NODE_T farthest = landmarks.front();
+        EDGEWEIGHT_T farthestDistance = 0;
+        for(NODE_T v = 0; v < n; ++v) {
+            EDGEWEIGHT_T closest = EDGEWEIGHT_INFINITY;
+            for(unsigned i = 0; i < numChosen; ++i) {
+                closest = std::min(closest, fromLandmark[size_t(v) * numLandmarks + i]);
+            }
+            if(closest != EDGEWEIGHT_INFINITY && closest > farthestDistance) {
+                farthest = v;
+                farthestDistance = closest;
+            }
+        }
+        return farthest;
+    }
+
+    // Avoid heuristic of Goldberg and Harrelson on the shortest path tree
+    // given by parent: each vertex weighs the difference between its
+    // distance from the root and the lower bound of the first numChosen
+    // landmarks. Subtrees containing a landmark weigh nothing. Starting at
+    // the root, the heaviest subtree is followed down to a leaf.
+    NODE_T getAvoidVertex(unsigned numChosen, const vector<EDGEWEIGHT_T> &distance, const vector<NODE_T> &parent, const vector<NODE_T> &settleOrder) {
+        const NODE_T root = settleOrder.front();
+        vector<uint64_t> size(n, 0);
+        vector<bool> hasLandmark(n, false);
+        for(unsigned i = 0; i < numChosen; ++i) {
+            hasLandmark[landmarks[i]] = true;
+        }
+        for(NODE_T v : settleOrder) {
+            EDGEWEIGHT_T bound = 0;
+            for(unsigned i = 0; i < numChosen; ++i) {
+                const EDGEWEIGHT_T fromRoot = fromLandmark[size_t(root) * numLandmarks + i];
+                const EDGEWEIGHT_T fromV = fromLandmark[size_t(v) * numLandmarks + i];
+                if(fromRoot != EDGEWEIGHT_INFINITY && fromV != EDGEWEIGHT_INFINITY && fromV > fromRoot) {
+                    bound = std::max<EDGEWEIGHT_T>(bound, fromV - fromRoot);
+                }
+            }
+            size[v] = distance[v] - std::min(bound, distance[v]);
+        }
+
+        vector<NODE_T> heaviestChild(n, NODE_INVALID);
+        for(auto it = settleOrder.rbegin(); it != settleOrder.rend(); ++it) {
+            const NODE_T v = *it;
+            const NODE_T p = parent[v];
+            if(hasLandmark[v]) {
+                size[v] = 0;
+                if(p != NODE_INVALID) {
+                    hasLandmark[p] = true;
+                }
+            }
+            else if(p != NODE_INVALID) {
+                size[p] += size[v];
+                if(heaviestChild[p] == NODE_INVALID || size[v] > size[heaviestChild[p]]) {
+                    heaviestChild[p] = v;
+                }
+            }
+        }
+
+        NODE_T v = root;
+        while(heaviestChild[v] != NODE_INVALID) {
+            v = heaviestChild[v];
+        }
+        return v;
+    }
+
+    NODE_T n;
+    NODE_T numLandmarks;
+    vector<NODE_T> landmarks;
+    // Row v holds the distances of v from and to each landmark
+    vector<EDGEWEIGHT_T> fromLandmark;
+    vector<EDGEWEIGHT_T> toLandmark;
+};
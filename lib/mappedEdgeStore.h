@@ -0,0 +1,313 @@
+/*******************************************************************************
+ * lib/mappedEdgeStore.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <mutex>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "definitions.h"
+
+using namespace std;
+
+// Backing store for the adjacency lists of the construction graph. Once
+// opened, all adjacency lists are allocated from a file mapped into memory,
+// so the kernel can write cold pages back to the file instead of keeping
+// them resident. Owners of adjacency lists mark them with markCold() once
+// they do not expect to touch them again soon. Whenever the store grows
+// beyond its budget, the pages holding only cold blocks are paged out.
+// The budget only refers to the size of the store, not to the memory of
+// the process.
+//
+// Until open() is called, allocations are served by malloc.
+class MappedEdgeStore {
+public:
+    static MappedEdgeStore &get() {
+        static MappedEdgeStore store;
+        return store;
+    }
+
+    void open(string fileName, size_t storeBudget, size_t reservedBytes = size_t(1) << 40) {
+        if(isOpen) {
+            std::cout << "Error! Mapped edge store is already open" << std::endl;
+            exit(1);
+        }
+        fd = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if(fd < 0) {
+            std::cout << "Error! Could not open " << fileName << " as edge store" << std::endl;
+            exit(1);
+        }
+        // The store only lives as long as this process
+        unlink(fileName.c_str());
+
+        void *reserved = mmap(nullptr, reservedBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if(reserved == MAP_FAILED) {
+            std::cout << "Error! Could not reserve " << reservedBytes << " bytes of address space for edge store" << std::endl;
+            exit(1);
+        }
+        base = static_cast<char *>(reserved);
+        reservedSize = reservedBytes;
+        mappedSize = 0;
+        usedSize = 0;
+        budget = storeBudget;
+        pageSize = sysconf(_SC_PAGESIZE);
+        freeLists.assign(64, nullptr);
+        coldGranules.clear();
+        coldBytesOfPage.clear();
+        newColdPages.clear();
+        evictedBytes = 0;
+        isOpen = true;
+    }
+
+    // Stops serving new allocations from the store. Used by forked worker
+    // processes, which share the mapping with their parent.
+    void detach() {
+        isOpen = false;
+    }
+
+    bool isActive() {
+        return isOpen;
+    }
+
+    void *allocate(size_t bytes) {
+        if(!isOpen) {
+            void *result = malloc(bytes);
+            if(result == nullptr) {
+                throw std::bad_alloc();
+            }
+            return result;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        unsigned sizeClass = getSizeClass(bytes);
+        if(freeLists[sizeClass] != nullptr) {
+            void *result = freeLists[sizeClass];
+            freeLists[sizeClass] = *static_cast<void **>(result);
+            setCold(static_cast<char *>(result) - base, size_t(1) << sizeClass, false);
+            return result;
+        }
+        size_t blockSize = size_t(1) << sizeClass;
+        if(usedSize + blockSize > mappedSize) {
+            grow(usedSize + blockSize);
+        }
+        void *result = base + usedSize;
+        usedSize += blockSize;
+        return result;
+    }
+
+    void deallocate(void *p, size_t bytes) {
+        if(!contains(p)) {
+            free(p);
+            return;
+        }
+        if(!isOpen) {
+            // Owned by the parent process
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        unsigned sizeClass = getSizeClass(bytes);
+        // Free blocks are as good as cold until they are handed out again
+        setCold(static_cast<char *>(p) - base, size_t(1) << sizeClass, true);
+        *static_cast<void **>(p) = freeLists[sizeClass];
+        freeLists[sizeClass] = p;
+    }
+
+    size_t getMappedBytes() {
+        return mappedSize;
+    }
+
+    // Scans the whole mapping, so only meant for diagnostics
+    size_t getResidentBytes() {
+        if(mappedSize == 0) {
+            return 0;
+        }
+        std::vector<unsigned char> resident((mappedSize + pageSize - 1) / pageSize);
+        mincore(base, mappedSize, resident.data());
+        size_t numResident = 0;
+        for(unsigned char page : resident) {
+            numResident += page & 1;
+        }
+        return numResident * pageSize;
+    }
+
+    // Marks the block at p that allocate() handed out for the given number
+    // of bytes as cold. It stays cold until it is handed out again after
+    // being deallocated.
+    void markCold(void *p, size_t bytes) {
+        if(!isOpen || bytes == 0 || !contains(p)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        setCold(static_cast<char *>(p) - base, size_t(1) << getSizeClass(bytes), true);
+    }
+
+    // Pages out the pages that only hold cold blocks and became cold since
+    // the last call. The store calls this itself whenever it grows beyond
+    // its budget.
+    void evictColdPages() {
+        std::lock_guard<std::mutex> lock(mutex);
+        evictColdPagesLocked();
+    }
+
+    size_t getEvictedBytes() {
+        return evictedBytes;
+    }
+
+protected:
+    MappedEdgeStore() : isOpen(false), fd(-1), base(nullptr), reservedSize(0), mappedSize(0), usedSize(0), budget(0), pageSize(0), evictedBytes(0) {
+    }
+
+    // Blocks start at multiples of granuleSize as all size classes are
+    // powers of two of at least granuleSize bytes
+    static constexpr size_t granuleSize = 16;
+
+    void setCold(size_t offset, size_t bytes, bool cold) {
+        for(size_t granule = offset / granuleSize; granule < (offset + bytes) / granuleSize; ++granule) {
+            const uint64_t bit = uint64_t(1) << (granule % 64);
+            if(((coldGranules[granule / 64] & bit) != 0) == cold) {
+                continue;
+            }
+            coldGranules[granule / 64] ^= bit;
+            const size_t page = granule * granuleSize / pageSize;
+            if(cold) {
+                coldBytesOfPage[page] += granuleSize;
+                if(coldBytesOfPage[page] == pageSize) {
+                    newColdPages.push_back(page);
+                }
+            }
+            else {
+                coldBytesOfPage[page] -= granuleSize;
+            }
+        }
+    }
+
+    void evictColdPagesLocked() {
+#ifdef MADV_PAGEOUT
+        const int advice = MADV_PAGEOUT;
+#else
+        const int advice = MADV_DONTNEED;
+#endif
+        std::sort(newColdPages.begin(), newColdPages.end());
+        newColdPages.erase(std::unique(newColdPages.begin(), newColdPages.end()), newColdPages.end());
+        size_t i = 0;
+        while(i < newColdPages.size()) {
+            if(coldBytesOfPage[newColdPages[i]] != pageSize) {
+                ++i;
+                continue;
+            }
+            // Page out runs of consecutive cold pages at once
+            size_t j = i + 1;
+            while(j < newColdPages.size() && newColdPages[j] == newColdPages[j - 1] + 1 && coldBytesOfPage[newColdPages[j]] == pageSize) {
+                ++j;
+            }
+            const size_t numPages = newColdPages[j - 1] - newColdPages[i] + 1;
+            // Dirty pages are not reclaimed, so write them back first
+            msync(base + newColdPages[i] * pageSize, numPages * pageSize, MS_SYNC);
+            madvise(base + newColdPages[i] * pageSize, numPages * pageSize, advice);
+            evictedBytes += numPages * pageSize;
+            i = j;
+        }
+        newColdPages.clear();
+    }
+
+    bool contains(void *p) {
+        return base != nullptr && static_cast<char *>(p) >= base && static_cast<char *>(p) < base + reservedSize;
+    }
+
+    unsigned getSizeClass(size_t bytes) {
+        unsigned sizeClass = 4;
+        while((size_t(1) << sizeClass) < bytes) {
+            ++sizeClass;
+        }
+        return sizeClass;
+    }
+
+    void grow(size_t minimumSize) {
+        size_t newSize = ((minimumSize + chunkSize - 1) / chunkSize) * chunkSize;
+        if(newSize > reservedSize) {
+            std::cout << "Error! Edge store exceeds its reserved " << reservedSize << " bytes" << std::endl;
+            exit(1);
+        }
+        if(ftruncate(fd, newSize) != 0) {
+            std::cout << "Error! Could not grow edge store to " << newSize << " bytes" << std::endl;
+            exit(1);
+        }
+        void *mapped = mmap(base + mappedSize, newSize - mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, mappedSize);
+        if(mapped == MAP_FAILED) {
+            std::cout << "Error! Could not map edge store" << std::endl;
+            exit(1);
+        }
+        mappedSize = newSize;
+        coldGranules.resize((mappedSize / granuleSize + 63) / 64, 0);
+        coldBytesOfPage.resize(mappedSize / pageSize, 0);
+        if(mappedSize > budget) {
+            evictColdPagesLocked();
+        }
+    }
+
+    static constexpr size_t chunkSize = size_t(64) << 20;
+
+    bool isOpen;
+    int fd;
+    char *base;
+    size_t reservedSize;
+    size_t mappedSize;
+    size_t usedSize;
+    size_t budget;
+    size_t pageSize;
+    size_t evictedBytes;
+    std::vector<void *> freeLists;
+    // One bit per granule of the mapping, set if the granule belongs to a
+    // cold block
+    std::vector<uint64_t> coldGranules;
+    std::vector<uint32_t> coldBytesOfPage;
+    // Pages whose bytes all became cold since the last eviction
+    std::vector<size_t> newColdPages;
+    std::mutex mutex;
+};
+
+template <typename T>
+class MappedEdgeStoreAllocator {
+public:
+    typedef T value_type;
+
+    MappedEdgeStoreAllocator() noexcept {
+    }
+
+    template <typename U>
+    MappedEdgeStoreAllocator(const MappedEdgeStoreAllocator<U> &) noexcept {
+    }
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(MappedEdgeStore::get().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        MappedEdgeStore::get().deallocate(p, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const MappedEdgeStoreAllocator<T> &, const MappedEdgeStoreAllocator<U> &) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const MappedEdgeStoreAllocator<T> &, const MappedEdgeStoreAllocator<U> &) {
+    return false;
+}
+
+typedef vector<edgeInfo, MappedEdgeStoreAllocator<edgeInfo>> edgeList;
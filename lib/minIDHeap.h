@@ -0,0 +1,132 @@
+/*******************************************************************************
+ * lib/minIDHeap.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include "assert.h"
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+// 4-ary min heap of (id, key) pairs with IDs below n, in which the key of an
+// ID can be decreased. It is the heap of PackedQueryState with the heap
+// positions kept in their own array, and replaces RoutingKit's MinIDQueue,
+// whose IDs and keys are 32 bit, for the widths set in definitions.h.
+template <typename ID_T, typename KEY_T>
+class MinIDHeap {
+public:
+    struct entry {
+        ID_T id;
+        KEY_T key;
+    };
+
+    MinIDHeap(ID_T n) : positions(n, POSITION_INVALID) {
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    size_t size() const {
+        return heap.size();
+    }
+
+    bool contains(ID_T id) const {
+        return positions[id] != POSITION_INVALID;
+    }
+
+    const entry &peek() const {
+        assert(!empty());
+        return heap[0];
+    }
+
+    // Removes all entries in time linear in their number
+    void clear() {
+        for(const entry &e : heap) {
+            positions[e.id] = POSITION_INVALID;
+        }
+        heap.clear();
+    }
+
+    // e.id must not be in the heap
+    void push(entry e) {
+        assert(!contains(e.id));
+        heap.push_back(e);
+        siftUp(heap.size() - 1);
+    }
+
+    // e.id must be in the heap with a key of at least e.key
+    void decreaseKey(entry e) {
+        assert(contains(e.id) && heap[positions[e.id]].key >= e.key);
+        const ID_T position = positions[e.id];
+        heap[position].key = e.key;
+        siftUp(position);
+    }
+
+    entry pop() {
+        assert(!empty());
+        const entry min = heap[0];
+        positions[min.id] = POSITION_INVALID;
+        const entry last = heap.back();
+        heap.pop_back();
+        if(!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return min;
+    }
+
+protected:
+    static constexpr ID_T POSITION_INVALID = numeric_limits<ID_T>::max();
+    static constexpr size_t HEAP_ARITY = 4;
+
+    void siftUp(size_t position) {
+        const entry e = heap[position];
+        while(position > 0) {
+            size_t parent = (position - 1) / HEAP_ARITY;
+            if(heap[parent].key <= e.key) {
+                break;
+            }
+            heap[position] = heap[parent];
+            positions[heap[position].id] = position;
+            position = parent;
+        }
+        heap[position] = e;
+        positions[e.id] = position;
+    }
+
+    void siftDown(size_t position) {
+        const entry e = heap[position];
+        while(true) {
+            size_t firstChild = HEAP_ARITY * position + 1;
+            if(firstChild >= heap.size()) {
+                break;
+            }
+            size_t lastChild = std::min(firstChild + HEAP_ARITY, heap.size());
+            size_t minChild = firstChild;
+            for(size_t child = firstChild + 1; child < lastChild; ++child) {
+                if(heap[child].key < heap[minChild].key) {
+                    minChild = child;
+                }
+            }
+            if(heap[minChild].key >= e.key) {
+                break;
+            }
+            heap[position] = heap[minChild];
+            positions[heap[position].id] = position;
+            position = minChild;
+        }
+        heap[position] = e;
+        positions[e.id] = position;
+    }
+
+    vector<entry> heap;
+    vector<ID_T> positions;
+};
@@ -0,0 +1,243 @@
+/*******************************************************************************
+ * lib/nodeOrdering.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#include "definitions.h"
+#include "edgeHierarchyGraph.h"
+
+using namespace std;
+
+// Node orders for the memory layout of the query graph. Every order is
+// returned as the new ID of each vertex, as expected by buildConsecutive and
+// buildPermuted.
+enum NodeOrder {
+    NODE_ORDER_CH = 0,
+    NODE_ORDER_DFS_PRE,
+    NODE_ORDER_DFS_POST,
+    NODE_ORDER_BFS,
+    NODE_ORDER_HILBERT,         // needs coordinates
+    NODE_ORDER_MAX_EDGE_RANK,
+    NODE_ORDER_PARTITION,
+    NODE_ORDER_HOT_CORE,
+    NUM_NODE_ORDERS
+};
+
+const char *const nodeOrderNames[NUM_NODE_ORDERS] = {"ch", "dfspre", "dfspost", "bfs", "hilbert", "maxrank", "partition", "hotcore"};
+
+NodeOrder getNodeOrderFromName(const string &name) {
+    for(unsigned order = 0; order < NUM_NODE_ORDERS; ++order) {
+        if(name == nodeOrderNames[order]) {
+            return NodeOrder(order);
+        }
+    }
+    std::cout << "Error! Unknown node order " << name << std::endl;
+    exit(1);
+}
+
+// Returns the BFS number of each vertex, ignoring edge directions
+vector<NODE_T> getBFSOrder(EdgeHierarchyGraph &g) {
+    const NODE_T n = g.getNumberOfNodes();
+    vector<NODE_T> bfsNum(n, NODE_INVALID);
+    vector<NODE_T> queue;
+    queue.reserve(n);
+
+    size_t queueHead = 0;
+    for(NODE_T root = 0; root < n; ++root) {
+        if(bfsNum[root] != NODE_INVALID) {
+            continue;
+        }
+        bfsNum[root] = queue.size();
+        queue.push_back(root);
+
+        while(queueHead < queue.size()) {
+            NODE_T v = queue[queueHead++];
+            auto visit = [&] (NODE_T w, EDGEWEIGHT_T weight) {
+                if(bfsNum[w] == NODE_INVALID) {
+                    bfsNum[w] = queue.size();
+                    queue.push_back(w);
+                }
+            };
+            g.forAllNeighborsOut(v, visit);
+            g.forAllNeighborsIn(v, visit);
+        }
+    }
+
+    return bfsNum;
+}
+
+// Assigns each vertex one of numPartitions blocks by cutting a BFS order
+// (ignoring edge directions) into pieces of equal size
+vector<NODE_T> getBFSPartition(EdgeHierarchyGraph &g, NODE_T numPartitions) {
+    const NODE_T n = g.getNumberOfNodes();
+    vector<NODE_T> partition = getBFSOrder(g);
+
+    for(NODE_T v = 0; v < n; ++v) {
+        partition[v] = (uint64_t(partition[v]) * numPartitions) / n;
+    }
+
+    return partition;
+}
+
+// Returns the position of each vertex when sorting all vertices by key, ties
+// being broken by vertex ID
+template<typename Key>
+vector<NODE_T> getOrderFromKeys(const vector<Key> &keys) {
+    const NODE_T n = keys.size();
+    vector<NODE_T> vertices(n);
+    std::iota(vertices.begin(), vertices.end(), 0);
+    std::stable_sort(vertices.begin(), vertices.end(), [&] (NODE_T v, NODE_T w) {
+            return keys[v] < keys[w];
+        });
+
+    vector<NODE_T> order(n);
+    for(NODE_T i = 0; i < n; ++i) {
+        order[vertices[i]] = i;
+    }
+    return order;
+}
+
+// Distance of (x, y) along the Hilbert curve filling a 2^16 x 2^16 grid
+uint32_t getHilbertIndex(uint32_t x, uint32_t y) {
+    uint32_t index = 0;
+    for(uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        index += s * s * ((3 * rx) ^ ry);
+        if(ry == 0) {
+            if(rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+// Orders the vertices along a Hilbert curve through their coordinates
+vector<NODE_T> getHilbertOrder(const vector<pair<int32_t, int32_t>> &coordinates) {
+    int64_t minX = INT32_MAX, maxX = INT32_MIN, minY = INT32_MAX, maxY = INT32_MIN;
+    for(auto &coordinate : coordinates) {
+        minX = std::min<int64_t>(minX, coordinate.first);
+        maxX = std::max<int64_t>(maxX, coordinate.first);
+        minY = std::min<int64_t>(minY, coordinate.second);
+        maxY = std::max<int64_t>(maxY, coordinate.second);
+    }
+    const int64_t extent = std::max<int64_t>(std::max(maxX - minX, maxY - minY), 1);
+
+    vector<uint32_t> hilbertIndex(coordinates.size());
+    for(size_t v = 0; v < coordinates.size(); ++v) {
+        uint32_t x = ((coordinates[v].first - minX) * 65535) / extent;
+        uint32_t y = ((coordinates[v].second - minY) * 65535) / extent;
+        hilbertIndex[v] = getHilbertIndex(x, y);
+    }
+    return getOrderFromKeys(hilbertIndex);
+}
+
+// Puts the vertices with the highest ranked incident edges first, as those
+// are the vertices reached by most queries
+vector<NODE_T> getMaxEdgeRankOrder(EdgeHierarchyGraph &g) {
+    vector<int64_t> key(g.getNumberOfNodes(), 0);
+    g.forAllNodes([&] (NODE_T v) {
+            EDGERANK_T maxRank = 0;
+            auto visit = [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                maxRank = std::max(maxRank, rank);
+            };
+            g.forAllNeighborsOutWithHighRank(v, 0, visit);
+            g.forAllNeighborsInWithHighRank(v, 0, visit);
+            key[v] = -int64_t(maxRank);
+        });
+    return getOrderFromKeys(key);
+}
+
+// Keeps the blocks of a BFS partition together and uses DFS pre order
+// inside of each block
+vector<NODE_T> getPartitionOrder(EdgeHierarchyGraph &g, NODE_T numPartitions) {
+    vector<NODE_T> partition = getBFSPartition(g, numPartitions);
+    vector<NODE_T> dfsNum = g.getDFSOrder<true>();
+
+    vector<pair<NODE_T, NODE_T>> key(g.getNumberOfNodes());
+    g.forAllNodes([&] (NODE_T v) {
+            key[v] = {partition[v], dfsNum[v]};
+        });
+    return getOrderFromKeys(key);
+}
+
+// Number of vertices in the hot core when it holds hotCorePercent percent of
+// the n vertices
+NODE_T getHotCoreSize(NODE_T n, double hotCorePercent) {
+    return std::min<NODE_T>(n, std::ceil(n * hotCorePercent / 100));
+}
+
+// Gives the vertices with the highest ranked incident edges, where almost
+// every query ends up, the lowest IDs so that their adjacency arrays and
+// their entries in the per vertex query state form one contiguous block at
+// the start. The base order is kept inside the hot core and for all other
+// vertices.
+vector<NODE_T> getHotCoreOrder(EdgeHierarchyGraph &g, const vector<NODE_T> &baseOrder, double hotCorePercent) {
+    const NODE_T n = g.getNumberOfNodes();
+    vector<NODE_T> maxEdgeRankOrder = getMaxEdgeRankOrder(g);
+    const NODE_T hotCoreSize = getHotCoreSize(n, hotCorePercent);
+
+    vector<pair<bool, NODE_T>> key(n);
+    g.forAllNodes([&] (NODE_T v) {
+            key[v] = {maxEdgeRankOrder[v] >= hotCoreSize, baseOrder[v]};
+        });
+    return getOrderFromKeys(key);
+}
+
+bool isNodeOrderAvailable(NodeOrder order, const vector<NODE_T> &chRank, const vector<pair<int32_t, int32_t>> &coordinates) {
+    if(order == NODE_ORDER_CH) {
+        return !chRank.empty();
+    }
+    if(order == NODE_ORDER_HILBERT) {
+        return !coordinates.empty();
+    }
+    return true;
+}
+
+vector<NODE_T> getNodeOrder(NodeOrder order, EdgeHierarchyGraph &g, const vector<NODE_T> &chRank, const vector<pair<int32_t, int32_t>> &coordinates, NODE_T numPartitions, double hotCorePercent) {
+    if(!isNodeOrderAvailable(order, chRank, coordinates)) {
+        std::cout << "Error! Node order " << nodeOrderNames[order] << " is not available for this graph" << std::endl;
+        exit(1);
+    }
+    switch(order) {
+    case NODE_ORDER_CH:
+        return chRank;
+    case NODE_ORDER_DFS_PRE:
+        return g.getDFSOrder<true>();
+    case NODE_ORDER_DFS_POST:
+        return g.getDFSOrder<false>();
+    case NODE_ORDER_BFS:
+        return getBFSOrder(g);
+    case NODE_ORDER_HILBERT:
+        if(coordinates.size() != g.getNumberOfNodes()) {
+            std::cout << "Error! Got " << coordinates.size() << " coordinates for " << g.getNumberOfNodes() << " vertices" << std::endl;
+            exit(1);
+        }
+        return getHilbertOrder(coordinates);
+    case NODE_ORDER_MAX_EDGE_RANK:
+        return getMaxEdgeRankOrder(g);
+    case NODE_ORDER_PARTITION:
+        return getPartitionOrder(g, numPartitions);
+    case NODE_ORDER_HOT_CORE:
+        return getHotCoreOrder(g, g.getDFSOrder<true>(), hotCorePercent);
+    default:
+        std::cout << "Error! Unknown node order " << order << std::endl;
+        exit(1);
+    }
+}
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * lib/parallelFor.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+unsigned getDefaultNumThreads() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// Calls callback(i) for all i in [begin, end) using numThreads threads. The
+// range is handed out in chunks of chunkSize to balance the load.
+template<typename F>
+void parallelFor(size_t begin, size_t end, unsigned numThreads, F &&callback, size_t chunkSize = 1024) {
+    if(numThreads <= 1 || end - begin <= chunkSize) {
+        for(size_t i = begin; i < end; ++i) {
+            callback(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextChunk(begin);
+    auto work = [&] () {
+        while(true) {
+            size_t chunkBegin = nextChunk.fetch_add(chunkSize);
+            if(chunkBegin >= end) {
+                return;
+            }
+            size_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+            for(size_t i = chunkBegin; i < chunkEnd; ++i) {
+                callback(i);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned t = 1; t < numThreads; ++t) {
+        threads.emplace_back(work);
+    }
+    work();
+    for(auto &thread : threads) {
+        thread.join();
+    }
+}
+
+// Replaces values[i] by values[0] + ... + values[i] using numThreads threads.
+// The values are split into one block per thread: the blocks are summed in
+// parallel, the block sums are scanned sequentially and then every block is
+// scanned starting from the sum of the blocks before it.
+template<typename T>
+void parallelPrefixSum(vector<T> &values, unsigned numThreads, size_t minBlockSize = 1 << 16) {
+    const size_t numBlocks = std::min<size_t>(numThreads, values.size() / minBlockSize);
+    if(numBlocks <= 1) {
+        std::partial_sum(values.begin(), values.end(), values.begin());
+        return;
+    }
+
+    const size_t blockSize = (values.size() + numBlocks - 1) / numBlocks;
+    std::vector<T> blockOffset(numBlocks + 1, 0);
+    parallelFor(0, numBlocks, numThreads, [&] (size_t block) {
+            const size_t begin = block * blockSize;
+            const size_t end = std::min(begin + blockSize, values.size());
+            blockOffset[block + 1] = std::accumulate(values.begin() + begin, values.begin() + end, T(0));
+        }, 1);
+    std::partial_sum(blockOffset.begin(), blockOffset.end(), blockOffset.begin());
+    parallelFor(0, numBlocks, numThreads, [&] (size_t block) {
+            const size_t begin = block * blockSize;
+            const size_t end = std::min(begin + blockSize, values.size());
+            T sum = blockOffset[block];
+            for(size_t i = begin; i < end; ++i) {
+                sum += values[i];
+                values[i] = sum;
+            }
+        }, 1);
+}
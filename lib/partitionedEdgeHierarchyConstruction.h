@@ -0,0 +1,262 @@
+/*******************************************************************************
+ * lib/partitionedEdgeHierarchyConstruction.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+
+#include "definitions.h"
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyWriter.h"
+#include "edgeHierarchyReader.h"
+#include "shortcutHelper.h"
+#include "mappedEdgeStore.h"
+#include "nodeOrdering.h"
+
+using namespace std;
+
+// Builds the edge hierarchy of each block in its own worker process and then
+// stitches the blocks together by ranking the remaining edges on top.
+//
+// A worker only ranks edges (u, v) where all incoming edges of u and all
+// outgoing edges of v lie inside the block. Shortcuts and weight decreases
+// caused by such an edge stay inside the block, so the workers never touch
+// the same edges and the result is the same as ranking the blocks one after
+// another. Edges incident to the block boundary stay unranked and are ranked
+// last in the stitching pass.
+//
+// The blocks are written to files before the workers start, so the graph is
+// released in the parent while they run. Stitching only ranks edges between
+// the stitch vertices, the endpoints of the unranked edges, and only shortcuts
+// or shortens edges between them. It therefore runs on the subgraph induced
+// by them, which is much smaller than the merged graph. Witness searches in it
+// miss the paths through the inside of the blocks, which can only add
+// shortcuts that are not needed.
+template <class EdgeRanker>
+class PartitionedEdgeHierarchyConstruction {
+public:
+    PartitionedEdgeHierarchyConstruction(EdgeHierarchyGraph &g, const vector<NODE_T> &partition, NODE_T numPartitions, unsigned maxWorkers, string tmpFilePrefix) :
+        g(g),
+        partition(partition),
+        numPartitions(numPartitions),
+        maxWorkers(std::max(maxWorkers, 1u)),
+        tmpFilePrefix(tmpFilePrefix) {
+    }
+
+    void run() {
+        const NODE_T n = g.getNumberOfNodes();
+        vector<bool> rankableTail(n, true);
+        vector<bool> rankableHead(n, true);
+        vector<NODE_T> localId(n);
+        vector<vector<NODE_T>> blockNodes(numPartitions);
+
+        g.forAllNodes([&] (NODE_T u) {
+                localId[u] = blockNodes[partition[u]].size();
+                blockNodes[partition[u]].push_back(u);
+                g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                        if(partition[u] != partition[v]) {
+                            rankableHead[u] = false;
+                            rankableTail[v] = false;
+                        }
+                    });
+            });
+
+        vector<tuple<NODE_T, NODE_T, EDGEWEIGHT_T>> boundaryEdges;
+        g.forAllNodes([&] (NODE_T u) {
+                g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                        if(partition[u] != partition[v]) {
+                            boundaryEdges.emplace_back(u, v, weight);
+                        }
+                    });
+            });
+        for(NODE_T block = 0; block < numPartitions; ++block) {
+            writeBlock(block, blockNodes[block], localId);
+        }
+        g = EdgeHierarchyGraph(n);
+
+        vector<pid_t> runningWorkers;
+        for(NODE_T block = 0; block < numPartitions; ++block) {
+            if(runningWorkers.size() >= maxWorkers) {
+                waitForWorker(runningWorkers);
+            }
+            std::cout << std::flush;
+            pid_t pid = fork();
+            if(pid < 0) {
+                std::cout << "Error! Could not fork worker for block " << block << std::endl;
+                exit(1);
+            }
+            if(pid == 0) {
+                MappedEdgeStore::get().detach();
+                buildBlock(block, blockNodes[block], rankableTail, rankableHead);
+                std::cout << std::flush;
+                _exit(0);
+            }
+            runningWorkers.push_back(pid);
+        }
+        while(!runningWorkers.empty()) {
+            waitForWorker(runningWorkers);
+        }
+
+        EDGERANK_T rankOffset = 0;
+        for(NODE_T block = 0; block < numPartitions; ++block) {
+            string blockFilename = getBlockFilename(block);
+            EdgeHierarchyGraph blockGraph = readEdgeHierarchy(blockFilename);
+            std::remove(blockFilename.c_str());
+
+            EDGERANK_T maxRank = 0;
+            blockGraph.forAllNodes([&] (NODE_T u) {
+                    blockGraph.forAllNeighborsOutWithHighRank(u, 0, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                            NODE_T uGlobal = blockNodes[block][u];
+                            NODE_T vGlobal = blockNodes[block][v];
+                            g.addEdge(uGlobal, vGlobal, weight);
+                            if(rank != EDGERANK_INFINIY) {
+                                g.setEdgeRank(uGlobal, vGlobal, rankOffset + rank);
+                                maxRank = std::max(maxRank, rank);
+                            }
+                        });
+                });
+            rankOffset += maxRank;
+        }
+
+        for(auto &edge : boundaryEdges) {
+            g.addEdge(get<0>(edge), get<1>(edge), get<2>(edge));
+        }
+        boundaryEdges.clear();
+        boundaryEdges.shrink_to_fit();
+
+        stitch(rankOffset);
+    }
+
+protected:
+    string getBlockFilename(NODE_T block) {
+        return tmpFilePrefix + ".block" + std::to_string(block) + ".eh";
+    }
+
+    string getBlockInputFilename(NODE_T block) {
+        return tmpFilePrefix + ".block" + std::to_string(block) + ".in.eh";
+    }
+
+    // Writes the edges inside the block, numbered by localId, for its worker
+    void writeBlock(NODE_T block, const vector<NODE_T> &nodes, const vector<NODE_T> &localId) {
+        EdgeHierarchyGraph blockGraph(nodes.size());
+        for(NODE_T u : nodes) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    if(partition[v] == block) {
+                        blockGraph.addEdge(localId[u], localId[v], weight);
+                    }
+                });
+        }
+        writeEdgeHierarchy(getBlockInputFilename(block), blockGraph);
+    }
+
+    void buildBlock(NODE_T block, const vector<NODE_T> &nodes, const vector<bool> &rankableTail, const vector<bool> &rankableHead) {
+        string inputFilename = getBlockInputFilename(block);
+        EdgeHierarchyGraph blockGraph = readEdgeHierarchy(inputFilename);
+        std::remove(inputFilename.c_str());
+        vector<bool> localRankableTail(nodes.size());
+        vector<bool> localRankableHead(nodes.size());
+        for(NODE_T i = 0; i < nodes.size(); ++i) {
+            localRankableTail[i] = rankableTail[nodes[i]];
+            localRankableHead[i] = rankableHead[nodes[i]];
+        }
+
+        std::cout << "Block " << block << " has " << blockGraph.getNumberOfNodes() << " vertices and " << blockGraph.getNumberOfEdges() << " edges" << std::endl;
+
+        shortcutHelperChNodeIds = nodes;
+
+        EdgeHierarchyQuery query(blockGraph);
+        EdgeHierarchyConstruction<EdgeRanker> construction(blockGraph, query, localRankableTail, localRankableHead);
+        construction.run();
+
+        writeEdgeHierarchy(getBlockFilename(block), blockGraph);
+    }
+
+    // Ranks the unranked edges of g above rankOffset on the subgraph induced
+    // by their endpoints and copies the ranks, shortcuts and decreased
+    // weights back
+    void stitch(EDGERANK_T rankOffset) {
+        const NODE_T n = g.getNumberOfNodes();
+        vector<NODE_T> stitchId(n, NODE_INVALID);
+        vector<NODE_T> stitchNodes;
+        auto addStitchNode = [&] (NODE_T v) {
+            if(stitchId[v] == NODE_INVALID) {
+                stitchId[v] = stitchNodes.size();
+                stitchNodes.push_back(v);
+            }
+        };
+        g.forAllNodes([&] (NODE_T u) {
+                g.forAllNeighborsOutWithHighRank(u, EDGERANK_INFINIY, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                        addStitchNode(u);
+                        addStitchNode(v);
+                    });
+            });
+
+        EdgeHierarchyGraph stitchGraph(stitchNodes.size());
+        for(NODE_T u : stitchNodes) {
+            g.forAllNeighborsOutWithHighRank(u, 0, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    if(stitchId[v] != NODE_INVALID) {
+                        stitchGraph.addEdge(stitchId[u], stitchId[v], weight);
+                        stitchGraph.setEdgeRank(stitchId[u], stitchId[v], rank);
+                    }
+                });
+        }
+
+        std::cout << "Stitching " << numPartitions << " blocks on " << stitchGraph.getNumberOfNodes() << " of " << n << " vertices on top of " << rankOffset << " ranked edges" << std::endl;
+
+        vector<NODE_T> chNodeIds = shortcutHelperChNodeIds;
+        shortcutHelperChNodeIds.clear();
+        for(NODE_T v : stitchNodes) {
+            shortcutHelperChNodeIds.push_back(chNodeIds.empty() ? v : chNodeIds[v]);
+        }
+        {
+            EdgeHierarchyQuery query(stitchGraph);
+            EdgeHierarchyConstruction<EdgeRanker> construction(stitchGraph, query);
+            construction.run(rankOffset + 1);
+        }
+        shortcutHelperChNodeIds = chNodeIds;
+
+        stitchGraph.forAllNodes([&] (NODE_T u) {
+                stitchGraph.forAllNeighborsOutWithHighRank(u, 0, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                        NODE_T uGlobal = stitchNodes[u];
+                        NODE_T vGlobal = stitchNodes[v];
+                        if(!g.hasEdge(uGlobal, vGlobal)) {
+                            g.addEdge(uGlobal, vGlobal, weight);
+                        }
+                        else if(weight < g.getEdgeWeight(uGlobal, vGlobal)) {
+                            g.decreaseEdgeWeight(uGlobal, vGlobal, weight);
+                        }
+                        g.setEdgeRank(uGlobal, vGlobal, rank);
+                    });
+            });
+    }
+
+    void waitForWorker(vector<pid_t> &runningWorkers) {
+        int status;
+        pid_t pid = wait(&status);
+        if(pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cout << "Error! Worker process failed" << std::endl;
+            exit(1);
+        }
+        runningWorkers.erase(std::find(runningWorkers.begin(), runningWorkers.end(), pid));
+    }
+
+    EdgeHierarchyGraph &g;
+    vector<NODE_T> partition;
+    NODE_T numPartitions;
+    unsigned maxWorkers;
+    string tmpFilePrefix;
+};
@@ -19,6 +19,9 @@ int numEquals = 0;
 
 bool shortcutHelperUseCH;
 RoutingKit::ContractionHierarchyQuery shortcutHelperChQuery;
+// Maps node IDs of the graph under construction to node IDs of the CH. Empty
+// means identity (only needed when constructing on a subgraph)
+std::vector<NODE_T> shortcutHelperChNodeIds;
 
 // first: shortest paths lost; second: edges to decrease
 template<bool returnEdgesToDecrease>
@@ -36,7 +39,12 @@ pair<vector<pair<NODE_T, NODE_T>>, vector<tuple<NODE_T, NODE_T, EDGEWEIGHT_T>>>
                                                                                      uPrimeVWeight + vPrimeWeight;
                                                                              EDGEWEIGHT_T distanceInQueryGraph;
                                                                              if(shortcutHelperUseCH) {
-                                                                                 shortcutHelperChQuery.reset().add_source(uPrime).add_target(vPrime).run<true, false>();
+                                                                                 if(shortcutHelperChNodeIds.empty()) {
+                                                                                     shortcutHelperChQuery.reset().add_source(uPrime).add_target(vPrime).run<true, false>();
+                                                                                 }
+                                                                                 else {
+                                                                                     shortcutHelperChQuery.reset().add_source(shortcutHelperChNodeIds[uPrime]).add_target(shortcutHelperChNodeIds[vPrime]).run<true, false>();
+                                                                                 }
                                                                                  distanceInQueryGraph = shortcutHelperChQuery.get_distance();
                                                                              }
                                                                              else {
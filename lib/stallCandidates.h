@@ -0,0 +1,172 @@
+/*******************************************************************************
+ * lib/stallCandidates.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <tuple>
+
+#include "definitions.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+
+using namespace std;
+
+enum StallCandidateOrder {
+    STALL_CANDIDATES_WEIGHT = 0, // lightest edges first
+    STALL_CANDIDATES_SAMPLE,     // edges that stalled most often on sample queries first
+    NUM_STALL_CANDIDATE_ORDERS
+};
+
+const char *const stallCandidateOrderNames[NUM_STALL_CANDIDATE_ORDERS] = {"weight", "sample"};
+
+StallCandidateOrder getStallCandidateOrderFromName(const string &name) {
+    for(unsigned order = 0; order < NUM_STALL_CANDIDATE_ORDERS; ++order) {
+        if(name == stallCandidateOrderNames[order]) {
+            return StallCandidateOrder(order);
+        }
+    }
+    std::cout << "Error! Unknown stall candidate order " << name << std::endl;
+    exit(1);
+}
+
+// A backward stalling check at v that looked at numEdges edges. If v was
+// stalled, the edge at position to neighbor did it, otherwise position is
+// numEdges and neighbor is NODE_INVALID.
+struct loggedStall {
+    NODE_T v;
+    NODE_T neighbor;
+    EDGEWEIGHT_T weight;
+    EDGECOUNT_T position;
+    EDGECOUNT_T numEdges;
+};
+
+// Short per vertex lists of the edges backward stalling checks instead of
+// all incoming (forward search) or outgoing (backward search) edges. Uses
+// the internal vertex IDs of the query graph the lists are built for.
+class StallCandidates {
+public:
+    StallCandidates(NODE_T n) : n(n), inBegin(n + 1, 0), outBegin(n + 1, 0) {
+    }
+
+    // Keeps the maxCandidates lightest edges of each vertex
+    template<class Graph>
+    void buildByWeight(Graph &g, unsigned maxCandidates) {
+        vector<vector<neighborWeight>> in(n), out(n);
+        for(NODE_T v = 0; v < n; ++v) {
+            g.forAllNeighborsInAndStop(v, [&] (NODE_T u, EDGEWEIGHT_T weight) {
+                    in[v].push_back({u, weight});
+                    return false;
+                });
+            g.forAllNeighborsOutAndStop(v, [&] (NODE_T u, EDGEWEIGHT_T weight) {
+                    out[v].push_back({u, weight});
+                    return false;
+                });
+        }
+        auto byWeight = [] (const neighborWeight &a, const neighborWeight &b) {
+            return a.weight < b.weight;
+        };
+        for(NODE_T v = 0; v < n; ++v) {
+            std::stable_sort(in[v].begin(), in[v].end(), byWeight);
+            std::stable_sort(out[v].begin(), out[v].end(), byWeight);
+        }
+        setLists(in, inBegin, inCandidates, maxCandidates);
+        setLists(out, outBegin, outCandidates, maxCandidates);
+    }
+
+    // Runs the sample queries (external vertex IDs) with full backward
+    // stalling and keeps the maxCandidates edges of each vertex that stalled
+    // it most often. Edges that never stalled are dropped.
+    template<class Query>
+    void buildFromSampleQueries(Query &query, const vector<pair<NODE_T, NODE_T>> &sampleQueries, unsigned maxCandidates) {
+        query.setStallCandidates(nullptr);
+        query.setLogStalls(true);
+        vector<loggedStall> stallsForward, stallsBackward;
+        for(auto &sampleQuery : sampleQueries) {
+            query.getDistance(sampleQuery.first, sampleQuery.second, -1);
+            stallsForward.insert(stallsForward.end(), query.stallLogForward.begin(), query.stallLogForward.end());
+            stallsBackward.insert(stallsBackward.end(), query.stallLogBackward.begin(), query.stallLogBackward.end());
+        }
+        query.setLogStalls(false);
+
+        setLists(getListsByFrequency(stallsForward), inBegin, inCandidates, maxCandidates);
+        setLists(getListsByFrequency(stallsBackward), outBegin, outCandidates, maxCandidates);
+    }
+
+    neighborWeightRange getCandidatesIn(NODE_T v) const {
+        return getRange(inBegin, inCandidates, v);
+    }
+
+    neighborWeightRange getCandidatesOut(NODE_T v) const {
+        return getRange(outBegin, outCandidates, v);
+    }
+
+    EDGECOUNT_T getNumberOfCandidates() const {
+        return inCandidates.size() + outCandidates.size();
+    }
+
+protected:
+    vector<vector<neighborWeight>> getListsByFrequency(vector<loggedStall> &stalls) {
+        std::sort(stalls.begin(), stalls.end(), [] (const loggedStall &a, const loggedStall &b) {
+                return std::tie(a.v, a.neighbor, a.weight) < std::tie(b.v, b.neighbor, b.weight);
+            });
+
+        stalls.erase(std::remove_if(stalls.begin(), stalls.end(), [] (const loggedStall &stall) {
+                    return stall.neighbor == NODE_INVALID;
+                }), stalls.end());
+
+        vector<vector<pair<size_t, neighborWeight>>> counted(n);
+        for(size_t i = 0; i < stalls.size();) {
+            size_t j = i;
+            while(j < stalls.size() && stalls[j].v == stalls[i].v && stalls[j].neighbor == stalls[i].neighbor && stalls[j].weight == stalls[i].weight) {
+                ++j;
+            }
+            counted[stalls[i].v].push_back({j - i, {stalls[i].neighbor, stalls[i].weight}});
+            i = j;
+        }
+
+        vector<vector<neighborWeight>> lists(n);
+        for(NODE_T v = 0; v < n; ++v) {
+            std::stable_sort(counted[v].begin(), counted[v].end(), [] (const pair<size_t, neighborWeight> &a, const pair<size_t, neighborWeight> &b) {
+                    return a.first > b.first;
+                });
+            for(auto &candidate : counted[v]) {
+                lists[v].push_back(candidate.second);
+            }
+        }
+        return lists;
+    }
+
+    void setLists(const vector<vector<neighborWeight>> &lists, vector<EDGECOUNT_T> &begin, vector<neighborWeight> &candidates, unsigned maxCandidates) {
+        candidates.clear();
+        for(NODE_T v = 0; v < n; ++v) {
+            begin[v] = candidates.size();
+            const size_t numCandidates = std::min<size_t>(lists[v].size(), maxCandidates);
+            candidates.insert(candidates.end(), lists[v].begin(), lists[v].begin() + numCandidates);
+        }
+        begin[n] = candidates.size();
+        candidates.shrink_to_fit();
+    }
+
+    neighborWeightRange getRange(const vector<EDGECOUNT_T> &begin, const vector<neighborWeight> &candidates, NODE_T v) const {
+        const size_t size = begin[v + 1] - begin[v];
+        if(size == 0) {
+            return {nullptr, nullptr, 1, 1, 0};
+        }
+        const neighborWeight &first = candidates[begin[v]];
+        return {&first.neighbor, &first.weight, sizeof(neighborWeight) / sizeof(NODE_T), sizeof(neighborWeight) / sizeof(EDGEWEIGHT_T), size};
+    }
+
+    NODE_T n;
+    vector<EDGECOUNT_T> inBegin;
+    vector<EDGECOUNT_T> outBegin;
+    vector<neighborWeight> inCandidates;
+    vector<neighborWeight> outCandidates;
+};
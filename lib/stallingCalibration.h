@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * lib/stallingCalibration.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <tuple>
+
+#include "definitions.h"
+#include "stallCandidates.h"
+
+using namespace std;
+
+// Chooses the percentage of edges each vertex checks for backward stalling
+// from the logged checks of one search direction. A stall at v saves the
+// savedEdges[v] edges v would have scanned otherwise, and each edge looked
+// at costs one. For every vertex, the prefix of edges with the largest
+// saving minus cost over the logged checks is kept. Vertices that were never
+// checked keep full stalling.
+vector<uint8_t> getStallingPercents(NODE_T n, vector<loggedStall> &checks, const vector<EDGECOUNT_T> &savedEdges) {
+    vector<uint8_t> percents(n, 100);
+    std::sort(checks.begin(), checks.end(), [] (const loggedStall &a, const loggedStall &b) {
+            return std::tie(a.v, a.position) < std::tie(b.v, b.position);
+        });
+
+    for(size_t i = 0; i < checks.size();) {
+        const NODE_T v = checks[i].v;
+        const EDGECOUNT_T numEdges = checks[i].numEdges;
+        size_t end = i;
+        while(end < checks.size() && checks[end].v == v) {
+            ++end;
+        }
+        if(numEdges == 0) {
+            i = end;
+            continue;
+        }
+
+        // Checking the first b edges costs min(position + 1, b) for each
+        // check and saves savedEdges[v] for each check stalled before b.
+        // Only b = 0 and b = position + 1 of some stall can be optimal.
+        const size_t numChecks = end - i;
+        int64_t costBelow = 0;
+        int64_t bestGain = 0;
+        EDGECOUNT_T bestBudget = 0;
+        for(size_t j = i; j < end && checks[j].position < numEdges;) {
+            const EDGECOUNT_T budget = checks[j].position + 1;
+            while(j < end && checks[j].position < budget) {
+                costBelow += checks[j].position + 1;
+                ++j;
+            }
+            const int64_t numStalled = j - i;
+            const int64_t gain = numStalled * int64_t(savedEdges[v]) - costBelow - int64_t(numChecks - numStalled) * budget;
+            if(gain > bestGain) {
+                bestGain = gain;
+                bestBudget = budget;
+            }
+        }
+        percents[v] = (uint64_t(bestBudget) * 100 + numEdges - 1) / numEdges;
+        i = end;
+    }
+    return percents;
+}
+
+// Runs the sample queries (external vertex IDs) with full backward stalling
+// and stores a stalling percentage for each vertex and direction in the
+// query graph of query
+template<class Graph, class Query>
+void calibrateStallingBudgets(Graph &g, Query &query, const vector<pair<NODE_T, NODE_T>> &sampleQueries) {
+    const NODE_T n = g.getNumberOfNodes();
+    query.setStallCandidates(nullptr);
+    query.setUseStallingBudgets(false);
+    query.setLogStalls(true);
+    vector<loggedStall> checksForward, checksBackward;
+    for(auto &sampleQuery : sampleQueries) {
+        query.getDistance(sampleQuery.first, sampleQuery.second, -1);
+        checksForward.insert(checksForward.end(), query.stallLogForward.begin(), query.stallLogForward.end());
+        checksBackward.insert(checksBackward.end(), query.stallLogBackward.begin(), query.stallLogBackward.end());
+    }
+    query.setLogStalls(false);
+
+    // The forward search checks incoming edges and would scan outgoing ones
+    vector<EDGECOUNT_T> outDegree(n), inDegree(n);
+    for(NODE_T v = 0; v < n; ++v) {
+        outDegree[v] = g.getOutDegree(v);
+        inDegree[v] = g.getInDegree(v);
+    }
+    vector<uint8_t> percentsIn = getStallingPercents(n, checksForward, outDegree);
+    vector<uint8_t> percentsOut = getStallingPercents(n, checksBackward, inDegree);
+    g.setStallingPercents(percentsIn, percentsOut);
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * lib/stronglyConnectedComponents.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "definitions.h"
+
+using namespace std;
+
+// Labels the strongly connected components of g with 0, 1, ... using an
+// iterative version of Tarjan's algorithm. Works on every graph with
+// forAllNeighborsOutWithHighRank. A component is labeled only after all
+// components it reaches, so u can only reach v if the label of u is at
+// least the label of v. As shortcuts never connect vertices that were not
+// connected before, an edge hierarchy has the same components as its input
+// graph.
+template<class Graph>
+vector<NODE_T> getStronglyConnectedComponents(Graph &g) {
+    const NODE_T n = g.getNumberOfNodes();
+
+    // Copy the edges once so that the DFS can resume the scan of a vertex
+    vector<size_t> firstOut(n + 1, 0);
+    vector<NODE_T> heads;
+    for(NODE_T v = 0; v < n; ++v) {
+        firstOut[v] = heads.size();
+        g.forAllNeighborsOutWithHighRank(v, 0, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                heads.push_back(w);
+            });
+    }
+    firstOut[n] = heads.size();
+
+    vector<NODE_T> component(n, NODE_INVALID);
+    vector<NODE_T> dfsNumber(n, NODE_INVALID);
+    vector<NODE_T> lowLink(n);
+    vector<size_t> nextEdge(n);
+    vector<NODE_T> tarjanStack;
+    vector<NODE_T> dfsStack;
+    NODE_T dfsCount = 0;
+    NODE_T numComponents = 0;
+
+    for(NODE_T root = 0; root < n; ++root) {
+        if(dfsNumber[root] != NODE_INVALID) {
+            continue;
+        }
+        dfsStack.push_back(root);
+        while(!dfsStack.empty()) {
+            const NODE_T v = dfsStack.back();
+            if(dfsNumber[v] == NODE_INVALID) {
+                dfsNumber[v] = lowLink[v] = dfsCount++;
+                nextEdge[v] = firstOut[v];
+                tarjanStack.push_back(v);
+            }
+            bool descended = false;
+            while(nextEdge[v] < firstOut[v + 1]) {
+                const NODE_T w = heads[nextEdge[v]++];
+                if(dfsNumber[w] == NODE_INVALID) {
+                    dfsStack.push_back(w);
+                    descended = true;
+                    break;
+                }
+                if(component[w] == NODE_INVALID) {
+                    lowLink[v] = std::min(lowLink[v], dfsNumber[w]);
+                }
+            }
+            if(descended) {
+                continue;
+            }
+
+            dfsStack.pop_back();
+            if(!dfsStack.empty()) {
+                const NODE_T parent = dfsStack.back();
+                lowLink[parent] = std::min(lowLink[parent], lowLink[v]);
+            }
+            if(lowLink[v] == dfsNumber[v]) {
+                NODE_T w;
+                do {
+                    w = tarjanStack.back();
+                    tarjanStack.pop_back();
+                    component[w] = numComponents;
+                } while(w != v);
+                ++numComponents;
+            }
+        }
+    }
+    return component;
+}
+
+// Returns the subgraph of g induced by its largest strongly connected
+// component. The remaining vertices keep their relative order. Meant to be
+// used before construction, ranks are not copied.
+template<class Graph>
+Graph getLargestComponentGraph(Graph &g) {
+    const NODE_T n = g.getNumberOfNodes();
+    vector<NODE_T> component = getStronglyConnectedComponents(g);
+
+    vector<NODE_T> componentSize(n, 0);
+    for(NODE_T v = 0; v < n; ++v) {
+        ++componentSize[component[v]];
+    }
+    const NODE_T largest = std::max_element(componentSize.begin(), componentSize.end()) - componentSize.begin();
+
+    vector<NODE_T> newId(n, NODE_INVALID);
+    NODE_T numNodes = 0;
+    for(NODE_T v = 0; v < n; ++v) {
+        if(component[v] == largest) {
+            newId[v] = numNodes++;
+        }
+    }
+
+    Graph result(numNodes);
+    for(NODE_T u = 0; u < n; ++u) {
+        if(newId[u] == NODE_INVALID) {
+            continue;
+        }
+        g.forAllNeighborsOutWithHighRank(u, 0, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                if(newId[v] != NODE_INVALID) {
+                    result.addEdge(newId[u], newId[v], weight);
+                }
+            });
+    }
+    return result;
+}
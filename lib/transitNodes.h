@@ -0,0 +1,362 @@
+/*******************************************************************************
+ * lib/transitNodes.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <queue>
+#include <functional>
+
+#include "definitions.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "hubLabels.h"
+#include "parallelFor.h"
+
+// Number of cells of the locality filter, see TransitNodes
+#define TRANSIT_NODES_DEFAULT_CELLS 256
+
+using namespace std;
+
+// Transit node routing on top of an EH query graph. The transit nodes are
+// the endpoints of all edges with a rank of at least rankThreshold, chosen as
+// the highest rank that gives the requested number of transit nodes. Each
+// vertex gets
+// - its access nodes: the transit nodes settled by its forward and backward
+//   EH search restricted to edges below rankThreshold, and
+// - the cells these restricted searches settle vertices in, for the
+//   locality filter. The vertices are cut into numCells ranges of
+//   consecutive internal IDs, which are close in the graph after a DFS
+//   order, and each vertex stores one bit per cell and direction.
+//
+// Let m be the vertex where the forward and backward EH searches of a
+// shortest s-t path meet. Ranks only grow towards m, so if the path up to m
+// from one side has an edge of rank >= rankThreshold, so does its last edge,
+// which makes m a transit node. Hence either the restricted searches of s
+// and t settle a common vertex, or the first transit nodes on both sides are
+// access nodes at their exact distances and the distance table between them
+// gives the exact distance. A common vertex also gives a common cell, so a
+// query is only answered by the table if the cells of s and t are disjoint.
+class TransitNodes {
+public:
+    TransitNodes() : numTransitNodes(0), rankThreshold(EDGERANK_INFINIY), numCells(0), cellWords(0) {
+    }
+
+    // The number of cells is capped at one cell per vertex
+    template<class Graph>
+    void build(Graph &g, NODE_T minTransitNodes, unsigned numThreads, size_t numCellsWanted = TRANSIT_NODES_DEFAULT_CELLS) {
+        const NODE_T n = g.getNumberOfNodes();
+        chooseTransitNodes(g, minTransitNodes);
+        numThreads = std::max(numThreads, 1u);
+        numCells = std::min<size_t>(std::max<size_t>(numCellsWanted, 1), std::max<size_t>(n, 1));
+        cellWords = (numCells + 63) / 64;
+
+        // The table is built like hub labels from the full search spaces of
+        // the transit nodes
+        vector<vector<NODE_T>> spaceHubs[2];
+        vector<vector<EDGEWEIGHT_T>> spaceDistances[2];
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            spaceHubs[direction].resize(numTransitNodes);
+            spaceDistances[direction].resize(numTransitNodes);
+        }
+        std::atomic<size_t> nextTransitNode(0);
+        parallelFor(0, numThreads, numThreads, [&] (size_t thread) {
+                EdgeHierarchyQueryOnly<false, true, false, false, Graph, PackedQueryState> query(g);
+                vector<pair<NODE_T, EDGEWEIGHT_T>> space;
+                for(size_t i = nextTransitNode++; i < numTransitNodes; i = nextTransitNode++) {
+                    for(unsigned direction = 0; direction < 2; ++direction) {
+                        space.clear();
+                        auto addToSpace = [&] (NODE_T v, EDGEWEIGHT_T distance) {
+                            space.emplace_back(v, distance);
+                        };
+                        if(direction == 0) {
+                            query.template forAllVerticesInSearchSpace<true>(transitNodes[i], addToSpace);
+                        }
+                        else {
+                            query.template forAllVerticesInSearchSpace<false>(transitNodes[i], addToSpace);
+                        }
+                        std::sort(space.begin(), space.end());
+                        for(auto [v, distance] : space) {
+                            spaceHubs[direction][i].push_back(v);
+                            spaceDistances[direction][i].push_back(distance);
+                        }
+                    }
+                }
+            }, 1);
+        table.resize(size_t(numTransitNodes) * numTransitNodes);
+        parallelFor(0, numTransitNodes, numThreads, [&] (size_t i) {
+                for(NODE_T j = 0; j < numTransitNodes; ++j) {
+                    table[i * numTransitNodes + j] = getShortestDistanceOverCommonHubs(spaceHubs[0][i].data(), spaceDistances[0][i].data(), spaceHubs[0][i].size(),
+                                                                                       spaceHubs[1][j].data(), spaceDistances[1][j].data(), spaceHubs[1][j].size());
+                }
+            }, 16);
+
+        vector<vector<accessEntry>> access[2];
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            access[direction].resize(n);
+            cells[direction].assign(size_t(n) * cellWords, 0);
+        }
+        std::atomic<size_t> nextVertex(0);
+        parallelFor(0, numThreads, numThreads, [&] (size_t thread) {
+                restrictedSearch search(n);
+                for(size_t v = nextVertex++; v < n; v = nextVertex++) {
+                    const NODE_T externalV = g.getExternalNodeNumber(v);
+                    for(unsigned direction = 0; direction < 2; ++direction) {
+                        uint64_t *vertexCells = &cells[direction][size_t(externalV) * cellWords];
+                        auto addToSpace = [&] (NODE_T u, EDGEWEIGHT_T distance) {
+                            const size_t cell = uint64_t(u) * numCells / n;
+                            vertexCells[cell / 64] |= uint64_t(1) << (cell % 64);
+                            if(transitIndex[u] != NODE_INVALID) {
+                                access[direction][externalV].push_back({transitIndex[u], distance});
+                            }
+                        };
+                        if(direction == 0) {
+                            search.template run<true>(g, v, rankThreshold, addToSpace);
+                        }
+                        else {
+                            search.template run<false>(g, v, rankThreshold, addToSpace);
+                        }
+                        removeDominatedAccessNodes(access[direction][externalV], direction == 0);
+                    }
+                }
+            }, 1);
+
+        for(unsigned direction = 0; direction < 2; ++direction) {
+            firstAccess[direction].assign(n + 1, 0);
+            accessNodes[direction].clear();
+            for(NODE_T v = 0; v < n; ++v) {
+                accessNodes[direction].insert(accessNodes[direction].end(), access[direction][v].begin(), access[direction][v].end());
+                firstAccess[direction][v + 1] = accessNodes[direction].size();
+            }
+        }
+    }
+
+    // True if the restricted searches of s and t settle vertices in a
+    // common cell, in which case the table may be wrong. Takes external
+    // vertex IDs.
+    bool isLocal(NODE_T s, NODE_T t) const {
+        const uint64_t *a = &cells[0][size_t(s) * cellWords];
+        const uint64_t *b = &cells[1][size_t(t) * cellWords];
+        for(size_t i = 0; i < cellWords; ++i) {
+            if((a[i] & b[i]) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Distance by table lookups, exact if the query is not local. Takes
+    // external vertex IDs.
+    EDGEWEIGHT_T getGlobalDistance(NODE_T s, NODE_T t) const {
+        EDGEWEIGHT_T distance = EDGEWEIGHT_INFINITY;
+        for(size_t i = firstAccess[0][s]; i < firstAccess[0][s + 1]; ++i) {
+            const accessEntry &sourceAccess = accessNodes[0][i];
+            const EDGEWEIGHT_T *row = &table[size_t(sourceAccess.transitNode) * numTransitNodes];
+            for(size_t j = firstAccess[1][t]; j < firstAccess[1][t + 1]; ++j) {
+                const accessEntry &targetAccess = accessNodes[1][j];
+                const EDGEWEIGHT_T between = row[targetAccess.transitNode];
+                if(between != EDGEWEIGHT_INFINITY) {
+                    distance = std::min<EDGEWEIGHT_T>(distance, sourceAccess.distance + between + targetAccess.distance);
+                }
+            }
+        }
+        return distance;
+    }
+
+    // Answers global queries from the table and local ones with query
+    template<class Query>
+    EDGEWEIGHT_T getDistance(Query &query, NODE_T s, NODE_T t, int stallingPercent) const {
+        if(isLocal(s, t)) {
+            return query.getDistance(s, t, stallingPercent);
+        }
+        return getGlobalDistance(s, t);
+    }
+
+    NODE_T getNumberOfTransitNodes() const {
+        return numTransitNodes;
+    }
+
+    EDGERANK_T getRankThreshold() const {
+        return rankThreshold;
+    }
+
+    size_t getNumberOfAccessNodes(bool forward) const {
+        return accessNodes[forward ? 0 : 1].size();
+    }
+
+    size_t getTableBytes() const {
+        return table.size() * sizeof(EDGEWEIGHT_T);
+    }
+
+    size_t getAccessNodeBytes() const {
+        return (firstAccess[0].size() + firstAccess[1].size()) * sizeof(size_t) + (accessNodes[0].size() + accessNodes[1].size()) * sizeof(accessEntry);
+    }
+
+    size_t getNumberOfCells() const {
+        return numCells;
+    }
+
+    size_t getLocalityFilterBytes() const {
+        return (cells[0].size() + cells[1].size()) * sizeof(uint64_t);
+    }
+
+protected:
+    struct accessEntry {
+        NODE_T transitNode;
+        EDGEWEIGHT_T distance;
+    };
+
+    // Rank respecting Dijkstra like the EH query, but without stalling and
+    // only over edges with ranks below a threshold
+    class restrictedSearch {
+    public:
+        restrictedSearch(NODE_T n) : distance(n, EDGEWEIGHT_INFINITY), rank(n, 0), settled(n, false) {
+        }
+
+        template<bool forward, class Graph, typename F>
+        void run(Graph &g, NODE_T source, EDGERANK_T rankThreshold, F &&callback) {
+            priority_queue<pair<EDGEWEIGHT_T, NODE_T>, vector<pair<EDGEWEIGHT_T, NODE_T>>, greater<pair<EDGEWEIGHT_T, NODE_T>>> queue;
+            distance[source] = 0;
+            rank[source] = 0;
+            touched.push_back(source);
+            queue.push({0, source});
+            while(!queue.empty()) {
+                const auto [distanceU, u] = queue.top();
+                queue.pop();
+                if(settled[u] || distanceU > distance[u]) {
+                    continue;
+                }
+                settled[u] = true;
+                callback(u, distanceU);
+                auto relax = [&] (NODE_T v, EDGERANK_T edgeRank, EDGEWEIGHT_T weight) {
+                    if(edgeRank >= rankThreshold) {
+                        return;
+                    }
+                    const EDGEWEIGHT_T distanceV = distanceU + weight;
+                    if(distanceV < distance[v]) {
+                        if(distance[v] == EDGEWEIGHT_INFINITY) {
+                            touched.push_back(v);
+                        }
+                        distance[v] = distanceV;
+                        rank[v] = edgeRank;
+                        queue.push({distanceV, v});
+                    }
+                    else if(distanceV == distance[v] && rank[v] < edgeRank) {
+                        rank[v] = edgeRank;
+                    }
+                };
+                if constexpr(forward) {
+                    g.forAllNeighborsOutWithHighRank(u, rank[u], relax);
+                }
+                else {
+                    g.forAllNeighborsInWithHighRank(u, rank[u], relax);
+                }
+            }
+            for(NODE_T v : touched) {
+                distance[v] = EDGEWEIGHT_INFINITY;
+                settled[v] = false;
+            }
+            touched.clear();
+        }
+
+    protected:
+        vector<EDGEWEIGHT_T> distance;
+        vector<EDGERANK_T> rank;
+        vector<bool> settled;
+        vector<NODE_T> touched;
+    };
+
+    // Picks the highest rank threshold whose edges have at least
+    // minTransitNodes endpoints, or all endpoints of edges if there are
+    // fewer
+    template<class Graph>
+    void chooseTransitNodes(Graph &g, NODE_T minTransitNodes) {
+        const NODE_T n = g.getNumberOfNodes();
+        // Highest rank of an edge at each vertex
+        vector<EDGERANK_T> maxRank(n, 0);
+        vector<bool> hasEdge(n, false);
+        for(NODE_T u = 0; u < n; ++u) {
+            g.forAllNeighborsOutWithHighRank(u, 0, [&] (NODE_T v, EDGERANK_T edgeRank, EDGEWEIGHT_T weight) {
+                    for(NODE_T endpoint : {u, v}) {
+                        if(!hasEdge[endpoint] || maxRank[endpoint] < edgeRank) {
+                            maxRank[endpoint] = edgeRank;
+                            hasEdge[endpoint] = true;
+                        }
+                    }
+                });
+        }
+        vector<EDGERANK_T> ranks;
+        for(NODE_T v = 0; v < n; ++v) {
+            if(hasEdge[v]) {
+                ranks.push_back(maxRank[v]);
+            }
+        }
+        std::sort(ranks.begin(), ranks.end(), std::greater<EDGERANK_T>());
+        if(ranks.empty() || minTransitNodes == 0) {
+            rankThreshold = EDGERANK_INFINIY;
+        }
+        else {
+            rankThreshold = ranks[std::min<size_t>(minTransitNodes, ranks.size()) - 1];
+        }
+
+        transitNodes.clear();
+        transitIndex.assign(n, NODE_INVALID);
+        for(NODE_T v = 0; v < n; ++v) {
+            if(hasEdge[v] && maxRank[v] >= rankThreshold) {
+                transitIndex[v] = transitNodes.size();
+                transitNodes.push_back(v);
+            }
+        }
+        numTransitNodes = transitNodes.size();
+    }
+
+    // Drops access nodes that another access node reaches at most as fast
+    // through the table, keeping the one with the smaller index on ties
+    void removeDominatedAccessNodes(vector<accessEntry> &access, bool forward) {
+        vector<accessEntry> kept;
+        for(const accessEntry &a : access) {
+            bool dominated = false;
+            for(const accessEntry &other : access) {
+                if(other.transitNode == a.transitNode) {
+                    continue;
+                }
+                const EDGEWEIGHT_T between = forward ? table[size_t(other.transitNode) * numTransitNodes + a.transitNode]
+                                                     : table[size_t(a.transitNode) * numTransitNodes + other.transitNode];
+                if(between == EDGEWEIGHT_INFINITY) {
+                    continue;
+                }
+                const EDGEWEIGHT_T viaOther = other.distance + between;
+                if(viaOther < a.distance || (viaOther == a.distance && other.transitNode < a.transitNode)) {
+                    dominated = true;
+                    break;
+                }
+            }
+            if(!dominated) {
+                kept.push_back(a);
+            }
+        }
+        access.swap(kept);
+    }
+
+    NODE_T numTransitNodes;
+    EDGERANK_T rankThreshold;
+    vector<NODE_T> transitNodes;
+    vector<NODE_T> transitIndex;
+    // Row i holds the distances from transit node i to all others
+    vector<EDGEWEIGHT_T> table;
+    // Indexed by external vertex IDs, forward and backward
+    vector<size_t> firstAccess[2];
+    vector<accessEntry> accessNodes[2];
+    size_t numCells;
+    size_t cellWords;
+    // cellWords words per vertex, indexed by external vertex IDs, forward
+    // and backward
+    vector<uint64_t> cells[2];
+};
@@ -6,6 +6,10 @@
  * All rights reserved.
  ******************************************************************************/
 
+#include <cstdio>
+#include <fstream>
+#include <string>
+
 #include <gtest/gtest.h>
 
 #include "dimacsGraphReader.h"
@@ -34,3 +38,15 @@ TEST(DimacsGraphReaderTests, SimpleTest) {
     EXPECT_EQ(g.getInDegree(4), 0);
     EXPECT_EQ(g.getOutDegree(4), 0);
 }
+
+TEST(DimacsGraphReaderTests, WeightOverflowExits) {
+    std::string fileName = ::testing::TempDir() + "overflowGraph.dimacs";
+    std::ofstream outfile(fileName);
+    outfile << "p sp 2 1" << std::endl;
+    outfile << "a 1 2 " << uint64_t(EDGEWEIGHT_INFINITY) << std::endl;
+    outfile.close();
+
+    EXPECT_EXIT(readGraphDimacs(fileName), ::testing::ExitedWithCode(1), "");
+    std::remove(fileName.c_str());
+    EXPECT_EQ(checkedNarrow<EDGEWEIGHT_T>(5, "Edge weight"), 5u);
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * tests/dominatedEdgeRemovalTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "dominatedEdgeRemoval.h"
+#include "edgeRanking/shortcutCountingRoundsEdgeRanker.h"
+
+#include "testGraphs.h"
+
+TEST(DominatedEdgeRemovalTest, RemovesOnlyDominatedEdges) {
+    EdgeHierarchyGraph g(4);
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 2, 1);
+    g.addEdge(0, 2, 5);
+    g.addEdge(2, 3, 1);
+    g.addEdge(1, 3, 2);
+    g.setEdgeRank(0, 1, 1);
+    g.setEdgeRank(1, 2, 2);
+    g.setEdgeRank(0, 2, 3);
+    g.setEdgeRank(2, 3, 4);
+    g.setEdgeRank(1, 3, 5);
+
+    EXPECT_EQ(removeDominatedEdges(g), 1);
+
+    EXPECT_FALSE(g.hasEdge(0, 2));
+    EXPECT_TRUE(g.hasEdge(1, 3));
+    EXPECT_EQ(g.getNumberOfEdges(), 4);
+    EXPECT_EQ(g.getOutDegree(0), 1);
+    EXPECT_EQ(g.getInDegree(2), 1);
+}
+
+TEST(DominatedEdgeRemovalTest, DistancesUnchangedAfterConstruction) {
+    EdgeHierarchyGraph g = getGridGraph();
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    EdgeHierarchyQuery query(g);
+    EdgeHierarchyConstruction<ShortcutCountingRoundsEdgeRanker> construction(g, query);
+    construction.run();
+
+    EDGECOUNT_T numEdges = g.getNumberOfEdges();
+    EDGECOUNT_T numRemoved = removeDominatedEdges(g);
+    EXPECT_EQ(g.getNumberOfEdges(), numEdges - numRemoved);
+
+    for(NODE_T u = 0; u < 60; ++u){
+        for(NODE_T v = 0; v < 60; ++v){
+            EXPECT_EQ(query.getDistance(u, v), originalGraphQuery.getDistance(u,v));
+        }
+    }
+}
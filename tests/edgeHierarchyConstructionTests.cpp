@@ -14,7 +14,11 @@
 #include "edgeHierarchyGraph.h"
 #include "edgeHierarchyQuery.h"
 #include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "edgeRanking/shortcutCountingRoundsEdgeRanker.h"
 
+#include "testGraphs.h"
 
 class ArbitraryOrderEdgeRanker {
 public:
@@ -241,3 +245,43 @@ TEST(EdgeHierarchyConstructionTest, EdgeDecreaseWithLevel) {
 
     EXPECT_EQ(query.getDistance(0, 4), 4);
 }
+
+template<class EdgeRanker, typename... EdgeRankerArgs>
+void expectUndirectedConstructionCorrect(EdgeRankerArgs... edgeRankerArgs) {
+    EdgeHierarchyGraph g = getSymmetricGridGraph();
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    EdgeHierarchyQuery query(g);
+    EdgeHierarchyConstruction<EdgeRanker, true> construction(g, query, edgeRankerArgs...);
+    construction.run();
+
+    EXPECT_TRUE(g.isSymmetric());
+    g.forAllNodes( [&] (NODE_T u) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    EXPECT_LT(g.getEdgeRank(u, v), EDGERANK_INFINIY);
+                });
+        });
+    g.sortEdges();
+
+    std::vector<NODE_T> order = g.getDFSOrder<true>();
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_GROUPED, false, true> queryGraph(g.getNumberOfNodes());
+    queryGraph.buildPermuted(g, order, 1);
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_GROUPED, false, true>, PackedQueryState> onlyQuery(queryGraph);
+
+    for(NODE_T u = 0; u < 40; ++u){
+        for(NODE_T v = 0; v < 40; ++v){
+            EDGEWEIGHT_T distance = originalGraphQuery.getDistance(u, v);
+            EXPECT_EQ(query.getDistance(u, v), distance);
+            EXPECT_EQ(onlyQuery.getDistance(u, v, -1), distance);
+        }
+    }
+}
+
+TEST(EdgeHierarchyConstructionTest, UndirectedArbitraryOrder) {
+    expectUndirectedConstructionCorrect<ArbitraryOrderEdgeRanker>();
+}
+
+TEST(EdgeHierarchyConstructionTest, UndirectedShortcutCountingRounds) {
+    expectUndirectedConstructionCorrect<ShortcutCountingRoundsEdgeRanker>(true);
+}
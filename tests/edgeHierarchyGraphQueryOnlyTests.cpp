@@ -0,0 +1,350 @@
+/*******************************************************************************
+ * tests/edgeHierarchyGraphQueryOnlyTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+#include <tuple>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+
+EdgeHierarchyGraph getRankedGraph() {
+    EdgeHierarchyGraph g(6);
+    g.addEdge(0, 1, 3);
+    g.addEdge(1, 0, 3);
+    g.addEdge(1, 2, 2);
+    g.addEdge(2, 1, 1);
+    g.addEdge(2, 3, 4);
+    g.addEdge(3, 4, 1);
+    g.addEdge(4, 5, 7);
+    g.addEdge(5, 0, 2);
+    g.addEdge(0, 4, 9);
+
+    EDGERANK_T rank = 1;
+    g.forAllNodes([&] (NODE_T u) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    g.setEdgeRank(u, v, (rank++ * 5) % 11);
+                });
+        });
+    g.sortEdges();
+    return g;
+}
+
+template<bool out, class Graph>
+std::vector<std::tuple<NODE_T, EDGERANK_T, EDGEWEIGHT_T>> getNeighbors(Graph &g, NODE_T v) {
+    std::vector<std::tuple<NODE_T, EDGERANK_T, EDGEWEIGHT_T>> result;
+    auto collect = [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+        result.emplace_back(w, rank, weight);
+    };
+    if(out) {
+        g.forAllNeighborsOutWithRank(v, collect);
+    }
+    else {
+        g.forAllNeighborsInWithRank(v, collect);
+    }
+    return result;
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, BuildConsecutiveMatchesMakeConsecutive) {
+    EdgeHierarchyGraph g = getRankedGraph();
+
+    EdgeHierarchyGraphQueryOnly expected = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    expected.makeConsecutive();
+
+    std::vector<NODE_T> order = g.getDFSOrder<true>();
+    EdgeHierarchyGraphQueryOnly result(g.getNumberOfNodes());
+    result.buildConsecutive(g, order);
+
+    EXPECT_EQ(result.getNumberOfEdges(), expected.getNumberOfEdges());
+    for(NODE_T v = 0; v < g.getNumberOfNodes(); ++v) {
+        EXPECT_EQ(result.getInternalNodeNumber(v), expected.getInternalNodeNumber(v));
+        EXPECT_EQ(getNeighbors<true>(result, v), getNeighbors<true>(expected, v));
+        EXPECT_EQ(getNeighbors<false>(result, v), getNeighbors<false>(expected, v));
+    }
+
+    for(NODE_T v = 0; v < g.getNumberOfNodes(); ++v) {
+        EXPECT_EQ(g.getOutDegree(v), 0);
+        EXPECT_EQ(g.getInDegree(v), 0);
+    }
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, BuildPermutedMatchesBuildConsecutive) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    std::vector<NODE_T> order = {3, 5, 0, 4, 1, 2};
+
+    EdgeHierarchyGraphQueryOnly result(g.getNumberOfNodes());
+    result.buildPermuted(g, order, 4);
+
+    std::vector<NODE_T> orderCopy = order;
+    EdgeHierarchyGraphQueryOnly expected(g.getNumberOfNodes());
+    expected.buildConsecutive(g, orderCopy);
+
+    EXPECT_EQ(result.getNumberOfEdges(), expected.getNumberOfEdges());
+    for(NODE_T v = 0; v < result.getNumberOfNodes(); ++v) {
+        EXPECT_EQ(result.getInternalNodeNumber(v), expected.getInternalNodeNumber(v));
+        EXPECT_EQ(getNeighbors<true>(result, v), getNeighbors<true>(expected, v));
+        EXPECT_EQ(getNeighbors<false>(result, v), getNeighbors<false>(expected, v));
+    }
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, FindRankCutoff) {
+    for(size_t length : {0, 1, 7, 8, 9, 17, 64, 65, 200}) {
+        std::vector<EDGERANK_T> ranks(length);
+        for(size_t i = 0; i < length; ++i) {
+            ranks[i] = 3 * (length - i);
+        }
+        for(EDGERANK_T threshold = 0; threshold <= 3 * length + 1; ++threshold) {
+            size_t expected = 0;
+            while(expected < length && ranks[expected] >= threshold) {
+                ++expected;
+            }
+            EXPECT_EQ(findRankCutoff(ranks.data(), 0, length, threshold), expected) << length << " " << threshold;
+        }
+    }
+
+    std::vector<EDGERANK_T> ranks = {EDGERANK_INFINIY, EDGERANK_INFINIY, 9, 5, 5, 1, 0, 0, 0, 0, 0};
+    EXPECT_EQ(findRankCutoff(ranks.data(), 0, ranks.size(), EDGERANK_INFINIY), 2);
+    EXPECT_EQ(findRankCutoff(ranks.data(), 3, ranks.size(), 5), 5);
+    EXPECT_EQ(findRankCutoff(ranks.data(), 3, 4, 0), 4);
+}
+
+std::vector<std::pair<NODE_T, EDGEWEIGHT_T>> getRange(const neighborWeightRange &range) {
+    std::vector<std::pair<NODE_T, EDGEWEIGHT_T>> result;
+    for(size_t i = 0; i < range.size; ++i) {
+        result.emplace_back(range.getNeighbor(i), range.getWeight(i));
+    }
+    return result;
+}
+
+template<EdgeLayout layout, bool useNodeSummaries = false>
+void expectSameAsGrouped(EdgeHierarchyGraph &g, std::vector<NODE_T> order) {
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_GROUPED> expected(g.getNumberOfNodes());
+    expected.buildPermuted(g, order, 1);
+    EdgeHierarchyGraphQueryOnlyLayout<layout, useNodeSummaries> result(g.getNumberOfNodes());
+    result.buildPermuted(g, order, 1);
+
+    for(NODE_T v = 0; v < result.getNumberOfNodes(); ++v) {
+        EXPECT_EQ(getNeighbors<true>(result, v), getNeighbors<true>(expected, v));
+        EXPECT_EQ(getNeighbors<false>(result, v), getNeighbors<false>(expected, v));
+        for(EDGERANK_T threshold = 0; threshold <= 11; ++threshold) {
+            std::vector<NODE_T> resultNeighbors, expectedNeighbors;
+            result.forAllNeighborsOutWithHighRank(v, threshold, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    resultNeighbors.push_back(w);
+                });
+            expected.forAllNeighborsOutWithHighRank(v, threshold, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    expectedNeighbors.push_back(w);
+                });
+            result.forAllNeighborsInWithHighRank(v, threshold, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    resultNeighbors.push_back(w);
+                });
+            expected.forAllNeighborsInWithHighRank(v, threshold, [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+                    expectedNeighbors.push_back(w);
+                });
+            EXPECT_EQ(resultNeighbors, expectedNeighbors);
+        }
+        if constexpr(EdgeHierarchyGraphQueryOnlyLayout<layout, useNodeSummaries>::hasNeighborRanges) {
+            for(int percent : {50, 100}) {
+                EXPECT_EQ(getRange(result.getNeighborRangeOut(v, percent)), getRange(expected.getNeighborRangeOut(v, percent)));
+                EXPECT_EQ(getRange(result.getNeighborRangeIn(v, percent)), getRange(expected.getNeighborRangeIn(v, percent)));
+            }
+        }
+        EXPECT_LE(result.getEdgeBytesBefore(v), result.getEdgeBytesBefore(v + 1));
+    }
+    EXPECT_EQ(result.getEdgeBytesBefore(0), 0u);
+    // Only the offsets and summaries of the vertices are left
+    EXPECT_LE(result.getAdjacencyBytes() - result.getEdgeBytesBefore(result.getNumberOfNodes()), (result.getNumberOfNodes() + 1) * (2 * sizeof(uint64_t) + 2 * sizeof(EDGECOUNT_T) + sizeof(nodeSummary)));
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, EdgeLayoutsAgree) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    std::vector<NODE_T> order = {3, 5, 0, 4, 1, 2};
+
+    expectSameAsGrouped<EDGE_LAYOUT_SPLIT>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_RANK_SPLIT>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_INTERLEAVED>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_COMPRESSED>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_PACKED>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_PACKED_16>(g, order);
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, PackedLayoutWithQuantizedRanks) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    g.forAllNodes([&] (NODE_T u) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    g.setEdgeRank(u, v, 1000 * g.getEdgeRank(u, v));
+                });
+        });
+    g.quantizeRanks();
+    std::vector<NODE_T> order = {3, 5, 0, 4, 1, 2};
+    expectSameAsGrouped<EDGE_LAYOUT_PACKED>(g, order);
+
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_GROUPED> grouped(g.getNumberOfNodes());
+    grouped.buildPermuted(g, order, 1);
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_PACKED> packed(g.getNumberOfNodes());
+    packed.buildPermuted(g, order, 1);
+    EXPECT_EQ(packed.getAdjacencyBytes() - 2 * packed.getNumberOfEdges() * sizeof(packedEdgeInfo),
+              grouped.getAdjacencyBytes() - 2 * grouped.getNumberOfEdges() * sizeof(edgeInfo));
+    if(sizeof(NODE_T) == 4) {
+        EXPECT_EQ(sizeof(packedEdgeInfo), 8u);
+    }
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, Packed16LayoutHoldsMoreLevels) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    g.forAllNodes([&] (NODE_T u) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    g.setEdgeRank(u, v, 1000 * g.getEdgeRank(u, v));
+                });
+        });
+    std::vector<NODE_T> order = {3, 5, 0, 4, 1, 2};
+    expectSameAsGrouped<EDGE_LAYOUT_PACKED_16>(g, order);
+
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_PACKED> packed(g.getNumberOfNodes());
+    EXPECT_EXIT(packed.buildPermuted(g, order, 1), ::testing::ExitedWithCode(1), "");
+}
+
+template<EdgeLayout layout>
+void expectUndirectedSameAsDirected(EdgeHierarchyGraph &g, std::vector<NODE_T> &order) {
+    EdgeHierarchyGraphQueryOnlyLayout<layout> expected(g.getNumberOfNodes());
+    expected.buildPermuted(g, order, 1);
+    EdgeHierarchyGraphQueryOnlyLayout<layout, false, true> result(g.getNumberOfNodes());
+    result.buildPermuted(g, order, 1);
+
+    EXPECT_EQ(result.getNumberOfEdges(), expected.getNumberOfEdges());
+    EXPECT_LT(result.getAdjacencyBytes(), expected.getAdjacencyBytes());
+    EXPECT_EQ(result.getNumberOfEdgesBefore(result.getNumberOfNodes()), result.getNumberOfEdges());
+    for(NODE_T v = 0; v < result.getNumberOfNodes(); ++v) {
+        EXPECT_EQ(getNeighbors<true>(result, v), getNeighbors<true>(expected, v));
+        EXPECT_EQ(getNeighbors<false>(result, v), getNeighbors<false>(expected, v));
+        EXPECT_EQ(result.getInDegree(v), expected.getInDegree(v));
+    }
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, UndirectedLayoutsShareAdjacencyArrays) {
+    EdgeHierarchyGraph g(5);
+    for(auto [u, v, weight, rank] : std::vector<std::tuple<NODE_T, NODE_T, EDGEWEIGHT_T, EDGERANK_T>>{{0, 1, 3, 4}, {1, 2, 2, 1}, {2, 3, 5, 3}, {3, 0, 1, 2}, {1, 4, 7, 5}}) {
+        g.addEdge(u, v, weight);
+        g.addEdge(v, u, weight);
+        g.setEdgeRank(u, v, rank);
+        g.setEdgeRank(v, u, rank);
+    }
+    EXPECT_TRUE(g.isSymmetric());
+    g.sortEdges();
+    std::vector<NODE_T> order = {3, 0, 4, 1, 2};
+    expectUndirectedSameAsDirected<EDGE_LAYOUT_GROUPED>(g, order);
+    expectUndirectedSameAsDirected<EDGE_LAYOUT_SPLIT>(g, order);
+    expectUndirectedSameAsDirected<EDGE_LAYOUT_RANK_SPLIT>(g, order);
+    expectUndirectedSameAsDirected<EDGE_LAYOUT_INTERLEAVED>(g, order);
+    expectUndirectedSameAsDirected<EDGE_LAYOUT_COMPRESSED>(g, order);
+    expectUndirectedSameAsDirected<EDGE_LAYOUT_PACKED>(g, order);
+
+    g.setEdgeRank(1, 4, 6);
+    EXPECT_FALSE(g.isSymmetric());
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, VarintRoundTrip) {
+    std::vector<uint64_t> values = {0, 1, 127, 128, 300, 16383, 16384, std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint64_t>::max()};
+    std::vector<uint8_t> bytes;
+    for(uint64_t value : values) {
+        appendVarint(bytes, value);
+    }
+    EXPECT_EQ(bytes.size(), 1 + 1 + 1 + 2 + 2 + 2 + 3 + 5 + 10);
+    const uint8_t *position = bytes.data();
+    for(uint64_t value : values) {
+        EXPECT_EQ(readVarint(position), value);
+    }
+    EXPECT_EQ(position, bytes.data() + bytes.size());
+
+    for(int64_t value : {0l, 1l, -1l, 63l, -64l, int64_t(NODE_INVALID), -int64_t(NODE_INVALID)}) {
+        EXPECT_EQ(zigzagDecode(zigzagEncode(value)), value);
+    }
+    EXPECT_EQ(zigzagEncode(-1), 1u);
+    EXPECT_EQ(zigzagEncode(1), 2u);
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, CompressedPartialScans) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    std::vector<NODE_T> order = {3, 5, 0, 4, 1, 2};
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_GROUPED> expected(g.getNumberOfNodes());
+    expected.buildPermuted(g, order, 1);
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_COMPRESSED> result(g.getNumberOfNodes());
+    result.buildPermuted(g, order, 1);
+    if(sizeof(edgeInfo) == 12) {
+        EXPECT_LT(result.getAdjacencyBytes(), expected.getAdjacencyBytes());
+    }
+
+    auto getPartial = [] (auto &graph, NODE_T v, int percent) {
+        std::vector<std::pair<NODE_T, EDGEWEIGHT_T>> neighbors;
+        graph.forAllNeighborsInAndStopPartial(v, [&] (NODE_T w, EDGEWEIGHT_T weight) {
+                neighbors.emplace_back(w, weight);
+                return false;
+            }, percent);
+        graph.forAllNeighborsOutAndStopPartial(v, [&] (NODE_T w, EDGEWEIGHT_T weight) {
+                neighbors.emplace_back(w, weight);
+                return neighbors.size() == 2;
+            }, percent);
+        if constexpr(std::remove_reference_t<decltype(graph)>::hasNeighborRanges) {
+            neighborWeightRange range = graph.getNeighborRangeOut(v, percent);
+            for(size_t i = 0; i < range.size; ++i) {
+                neighbors.emplace_back(range.getNeighbor(i), range.getWeight(i));
+            }
+        }
+        else {
+            graph.forAllNeighborsOutAndStopPartial(v, [&] (NODE_T w, EDGEWEIGHT_T weight) {
+                    neighbors.emplace_back(w, weight);
+                    return false;
+                }, percent);
+        }
+        neighbors.emplace_back(graph.getOutDegree(v), graph.getInDegree(v));
+        return neighbors;
+    };
+    for(NODE_T v = 0; v < result.getNumberOfNodes(); ++v) {
+        for(int percent : {0, 50, 100}) {
+            EXPECT_EQ(getPartial(result, v, percent), getPartial(expected, v, percent));
+        }
+    }
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, NodeSummariesAgree) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    std::vector<NODE_T> order = {3, 5, 0, 4, 1, 2};
+
+    expectSameAsGrouped<EDGE_LAYOUT_GROUPED, true>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_SPLIT, true>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_RANK_SPLIT, true>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_INTERLEAVED, true>(g, order);
+    expectSameAsGrouped<EDGE_LAYOUT_PACKED, true>(g, order);
+}
+
+TEST(EdgeHierarchyGraphQueryOnlyTest, InterleavedMakeConsecutive) {
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_INTERLEAVED> g(3);
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 2, 2);
+    g.addEdge(2, 0, 3);
+    g.addEdge(0, 2, 4);
+    g.setEdgeRank(0, 1, 2);
+    g.setEdgeRank(1, 2, 3);
+    g.setEdgeRank(2, 0, 1);
+    g.setEdgeRank(0, 2, 4);
+    g.makeConsecutive();
+
+    // Vertex 0 has two outgoing and one incoming edge
+    EXPECT_EQ(g.getNumberOfEdgesBefore(0), 0);
+    EXPECT_EQ(g.getNumberOfEdgesBefore(1), 3);
+    EXPECT_EQ(g.getNumberOfEdgesBefore(2), 5);
+
+    typedef std::vector<std::tuple<NODE_T, EDGERANK_T, EDGEWEIGHT_T>> neighbors;
+    EXPECT_EQ(getNeighbors<true>(g, 0), neighbors({{2, 4, 4}, {1, 2, 1}}));
+    EXPECT_EQ(getNeighbors<false>(g, 0), neighbors({{2, 1, 3}}));
+    EXPECT_EQ(getNeighbors<true>(g, 1), neighbors({{2, 3, 2}}));
+    EXPECT_EQ(getNeighbors<false>(g, 1), neighbors({{0, 2, 1}}));
+    EXPECT_EQ(getNeighbors<true>(g, 2), neighbors({{0, 1, 3}}));
+    EXPECT_EQ(getNeighbors<false>(g, 2), neighbors({{0, 4, 4}, {1, 3, 2}}));
+}
@@ -221,6 +221,72 @@ TEST(EdgeHierarchyGraphTest, EdgeLevels) {
     EXPECT_EQ(result.size(), 0);
 }
 
+TEST(EdgeHierarchyGraphTest, QuantizeRanks) {
+    EdgeHierarchyGraph g(6);
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 2, 1);
+    g.addEdge(2, 3, 1);
+    g.addEdge(4, 5, 1);
+    g.setEdgeRank(0, 1, 100);
+    g.setEdgeRank(1, 2, 50);
+    g.setEdgeRank(2, 3, 70);
+    g.setEdgeRank(4, 5, 1000);
+
+    EXPECT_EQ(g.quantizeRanks(), 2);
+    EXPECT_EQ(g.getEdgeRank(1, 2), 0);
+    EXPECT_EQ(g.getEdgeRank(2, 3), 1);
+    EXPECT_EQ(g.getEdgeRank(0, 1), 1);
+    EXPECT_EQ(g.getEdgeRank(4, 5), 0);
+
+    vector<tuple<NODE_T, EDGERANK_T, EDGEWEIGHT_T>> result;
+    g.forAllNeighborsInWithHighRank(2, 0, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+            result.push_back(make_tuple(v, rank, weight));
+        });
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], make_tuple(1u, 0u, 1u));
+}
+
+TEST(EdgeHierarchyGraphTest, QuantizeRanksKeepsOrderAtVertices) {
+    const NODE_T n = 50;
+    EdgeHierarchyGraph g(n);
+    for(NODE_T u = 0; u < n; ++u) {
+        for(NODE_T v : {(u + 1) % n, (u * 7 + 3) % n, (u * 13 + 5) % n}) {
+            if(u != v && !g.hasEdge(u, v)) {
+                g.addEdge(u, v, 1);
+                g.setEdgeRank(u, v, (u * 31 + v * 17) % 40);
+            }
+        }
+    }
+
+    auto getIncidentRanks = [&] (NODE_T v) {
+        vector<EDGERANK_T> ranks;
+        auto collect = [&] (NODE_T w, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+            ranks.push_back(rank);
+        };
+        g.forAllNeighborsOutWithHighRank(v, 0, collect);
+        g.forAllNeighborsInWithHighRank(v, 0, collect);
+        return ranks;
+    };
+    vector<vector<EDGERANK_T>> ranksBefore;
+    for(NODE_T v = 0; v < n; ++v) {
+        ranksBefore.push_back(getIncidentRanks(v));
+    }
+
+    EDGERANK_T numLevels = g.quantizeRanks();
+    EXPECT_LE(numLevels, 40);
+    for(NODE_T v = 0; v < n; ++v) {
+        vector<EDGERANK_T> levels = getIncidentRanks(v);
+        ASSERT_EQ(levels.size(), ranksBefore[v].size());
+        for(size_t i = 0; i < levels.size(); ++i) {
+            EXPECT_LT(levels[i], numLevels);
+            for(size_t j = 0; j < levels.size(); ++j) {
+                EXPECT_EQ(levels[i] < levels[j], ranksBefore[v][i] < ranksBefore[v][j]);
+                EXPECT_EQ(levels[i] == levels[j], ranksBefore[v][i] == ranksBefore[v][j]);
+            }
+        }
+    }
+}
+
 TEST(EdgeHierarchyGraphTest, DecreaseEdgeWeightDuplicate) {
     EdgeHierarchyGraph g(2);
     g.addEdge(0, 1, 5);
@@ -307,3 +373,93 @@ TEST(EdgeHierarchyGraphTest, dfsOrderSimple) {
     EXPECT_TRUE(orderedG.hasEdge(3, 2));
     EXPECT_EQ(orderedG.getEdgeWeight(3, 2), g.getEdgeWeight(0, 1));
 }
+
+TEST(EdgeHierarchyGraphTest, dfsOrderMultipleRoots) {
+    EdgeHierarchyGraph g(5);
+
+    g.addEdge(1, 0, 1);
+    g.addEdge(3, 2, 1);
+    g.addEdge(2, 4, 1);
+
+    std::vector<NODE_T> preOrder = g.getDFSOrder<true>();
+    EXPECT_EQ(preOrder, std::vector<NODE_T>({0, 1, 2, 4, 3}));
+
+    std::vector<NODE_T> postOrder = g.getDFSOrder<false>();
+    EXPECT_EQ(postOrder, std::vector<NODE_T>({0, 1, 3, 4, 2}));
+}
+
+TEST(EdgeHierarchyGraphTest, ReorderedGraphKeepsRanks) {
+    EdgeHierarchyGraph g(4);
+
+    g.addEdge(0, 1, 1);
+    g.addEdge(0, 2, 2);
+    g.addEdge(0, 3, 3);
+    g.addEdge(2, 1, 4);
+    g.addEdge(3, 0, 5);
+    g.setEdgeRank(0, 1, 2);
+    g.setEdgeRank(0, 2, 7);
+    g.setEdgeRank(0, 3, 4);
+    g.setEdgeRank(2, 1, 1);
+
+    std::vector<NODE_T> perm = {2, 0, 3, 1};
+    EdgeHierarchyGraph reorderedG = g.getReorderedGraph<EdgeHierarchyGraph>(perm, 2);
+
+    EXPECT_EQ(reorderedG.getNumberOfEdges(), g.getNumberOfEdges());
+    g.forAllNodes([&] (NODE_T u) {
+            EXPECT_EQ(reorderedG.getInternalNodeNumber(u), perm[u]);
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    EXPECT_TRUE(reorderedG.hasEdge(perm[u], perm[v]));
+                    EXPECT_EQ(reorderedG.getEdgeWeight(perm[u], perm[v]), weight);
+                    EXPECT_EQ(reorderedG.getEdgeRank(perm[u], perm[v]), g.getEdgeRank(u, v));
+                });
+        });
+
+    std::vector<EDGERANK_T> ranks;
+    reorderedG.forAllNeighborsOutWithHighRank(perm[0], 0, [&] (NODE_T v, EDGERANK_T rank, EDGEWEIGHT_T weight) {
+            ranks.push_back(rank);
+        });
+    EXPECT_EQ(ranks, std::vector<EDGERANK_T>({7, 4, 2}));
+}
+
+TEST(EdgeHierarchyGraphTest, TurnCostGraph) {
+    //     1     2     5
+    // 0 <---> 1 ---> 2 ---> 4
+    //         |
+    //         v 3
+    //         3
+    EdgeHierarchyGraph g(5);
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 0, 1);
+    g.addEdge(1, 2, 2);
+    g.addEdge(1, 3, 3);
+    g.addEdge(2, 4, 5);
+
+    TurnCostTable turnCosts;
+    turnCosts[TURN_THROUGH] = 10;
+    turnCosts[TURN_JUNCTION] = 20;
+    turnCosts[TURN_UTURN] = 100;
+
+    EdgeHierarchyGraph turnCostGraph = g.getTurnCostGraph(turnCosts, 2);
+
+    // Vertices: 0 = (0, 1), 1 = (1, 0), 2 = (1, 2), 3 = (1, 3), 4 = (2, 4)
+    EXPECT_EQ(turnCostGraph.getNumberOfNodes(), 5);
+    EXPECT_EQ(turnCostGraph.getNumberOfEdges(), 5);
+
+    EXPECT_EQ(turnCostGraph.getEdgeWeight(0, 1), 101);
+    EXPECT_EQ(turnCostGraph.getEdgeWeight(0, 2), 21);
+    EXPECT_EQ(turnCostGraph.getEdgeWeight(0, 3), 21);
+    EXPECT_EQ(turnCostGraph.getEdgeWeight(1, 0), 101);
+    EXPECT_EQ(turnCostGraph.getEdgeWeight(2, 4), 12);
+    EXPECT_EQ(turnCostGraph.getOutDegree(3), 0);
+    EXPECT_EQ(turnCostGraph.getOutDegree(4), 0);
+
+    EXPECT_EQ(turnCostGraph.getInDegree(0), 1);
+    EXPECT_EQ(turnCostGraph.getInDegree(1), 1);
+    EXPECT_EQ(turnCostGraph.getInDegree(2), 1);
+    EXPECT_EQ(turnCostGraph.getInDegree(3), 1);
+    EXPECT_EQ(turnCostGraph.getInDegree(4), 1);
+    turnCostGraph.forAllNeighborsIn(4, [&] (NODE_T u, EDGEWEIGHT_T weight) {
+            EXPECT_EQ(u, 2);
+            EXPECT_EQ(weight, 12);
+        });
+}
@@ -0,0 +1,233 @@
+/*******************************************************************************
+ * tests/edgeHierarchyQueryStateTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "edgeHierarchyQueryState.h"
+
+#include "testGraphs.h"
+
+EdgeHierarchyGraph getRankedGraph() {
+    EdgeHierarchyGraph g(6);
+    g.addEdge(0, 1, 3);
+    g.addEdge(1, 0, 3);
+    g.addEdge(1, 2, 2);
+    g.addEdge(2, 1, 1);
+    g.addEdge(2, 3, 4);
+    g.addEdge(3, 4, 1);
+    g.addEdge(4, 5, 7);
+    g.addEdge(5, 0, 2);
+    g.addEdge(0, 4, 9);
+
+    EDGERANK_T rank = 1;
+    g.forAllNodes([&] (NODE_T u) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    g.setEdgeRank(u, v, (rank++ * 5) % 11);
+                });
+        });
+    g.sortEdges();
+    return g;
+}
+
+// Pushes and decreases random distances and returns the distances in the
+// order they are popped
+template<class QueryState>
+std::vector<EDGEWEIGHT_T> getPopOrder(QueryState &state, NODE_T n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<EDGEWEIGHT_T> distanceDist(1, 1000);
+    std::uniform_int_distribution<NODE_T> nodeDist(0, n - 1);
+
+    state.reset();
+    for(unsigned i = 0; i < 4 * n; ++i) {
+        NODE_T v = nodeDist(gen);
+        EDGEWEIGHT_T distance = distanceDist(gen);
+        if(!state.isPushed(v)) {
+            state.push(v, distance, i);
+        }
+        else if(distance < state.getDistance(v)) {
+            state.decreaseDistance(v, distance, i);
+        }
+    }
+
+    std::vector<EDGEWEIGHT_T> result;
+    while(!state.queueEmpty()) {
+        EDGEWEIGHT_T minDistance = state.getMinDistance();
+        NODE_T v = state.pop();
+        EXPECT_EQ(state.getDistance(v), minDistance);
+        result.push_back(minDistance);
+    }
+    return result;
+}
+
+TEST(EdgeHierarchyQueryStateTest, PackedStatePopsInDistanceOrder) {
+    PackedQueryState state(100);
+    for(unsigned seed = 0; seed < 5; ++seed) {
+        std::vector<EDGEWEIGHT_T> popOrder = getPopOrder(state, 100, seed);
+        EXPECT_TRUE(std::is_sorted(popOrder.begin(), popOrder.end()));
+    }
+}
+
+TEST(EdgeHierarchyQueryStateTest, SplitAndPackedStatesAgree) {
+    SplitQueryState split(100);
+    PackedQueryState packed(100);
+    for(unsigned seed = 0; seed < 5; ++seed) {
+        EXPECT_EQ(getPopOrder(split, 100, seed), getPopOrder(packed, 100, seed));
+    }
+}
+
+TEST(EdgeHierarchyQueryStateTest, PackedStateReset) {
+    PackedQueryState state(3);
+    state.reset();
+    state.push(1, 5, 2);
+    EXPECT_TRUE(state.isPushed(1));
+    EXPECT_FALSE(state.isPushed(0));
+    EXPECT_EQ(state.getRank(1), 2u);
+    state.setRank(1, 4);
+    EXPECT_EQ(state.getRank(1), 4u);
+
+    state.reset();
+    EXPECT_FALSE(state.isPushed(1));
+    EXPECT_TRUE(state.queueEmpty());
+    state.push(1, 7, 0);
+    EXPECT_EQ(state.pop(), 1u);
+    EXPECT_TRUE(state.queueEmpty());
+}
+
+TEST(EdgeHierarchyQueryStateTest, FindShorterPathMatchesScalar) {
+    const NODE_T n = 200;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<NODE_T> nodeDist(0, n - 1);
+    std::uniform_int_distribution<EDGEWEIGHT_T> weightDist(0, 300);
+
+    PackedQueryState packed(n);
+    SplitQueryState split(n);
+    for(unsigned round = 0; round < 20; ++round) {
+        packed.reset();
+        split.reset();
+        for(NODE_T i = 0; i < n / 2; ++i) {
+            NODE_T v = nodeDist(gen);
+            if(!packed.isPushed(v)) {
+                EDGEWEIGHT_T distance = weightDist(gen);
+                packed.push(v, distance, 0);
+                split.push(v, distance, 0);
+            }
+        }
+
+        for(size_t stride = 1; stride <= 3; ++stride) {
+            for(size_t size : {0, 5, 8, 16, 37}) {
+                // Like the packed layout, the masked ranges have a rank
+                // level above the weight
+                const bool masked = size % 2 == 1;
+                std::vector<NODE_T> neighbors(size * stride);
+                std::vector<EDGEWEIGHT_T> weights(size * stride);
+                for(size_t i = 0; i < size; ++i) {
+                    neighbors[i * stride] = nodeDist(gen);
+                    weights[i * stride] = weightDist(gen) | (masked ? EDGEWEIGHT_T(i) << 12 : 0);
+                }
+                neighborWeightRange range = {neighbors.data(), weights.data(), stride, stride, size, masked ? EDGEWEIGHT_T(0xFFF) : EDGEWEIGHT_INFINITY};
+                for(EDGEWEIGHT_T distance : std::vector<EDGEWEIGHT_T>({0, 50, 200, 400, EDGEWEIGHT_INFINITY})) {
+                    size_t expected = findShorterPathScalar(packed, range, 0, distance);
+                    EXPECT_EQ(packed.findShorterPath(range, distance), expected);
+                    EXPECT_EQ(split.findShorterPath(range, distance), expected);
+                }
+            }
+        }
+    }
+}
+
+TEST(EdgeHierarchyQueryStateTest, QueryStatesGiveSameDistances) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, SplitQueryState> splitQuery(queryGraph);
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> packedQuery(queryGraph);
+    EdgeHierarchyQueryOnly<true, false, false, false, EdgeHierarchyGraphQueryOnly, SplitQueryState> splitForwardStallingQuery(queryGraph);
+    EdgeHierarchyQueryOnly<true, false, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> packedForwardStallingQuery(queryGraph);
+
+    g.forAllNodes([&] (NODE_T s) {
+            g.forAllNodes([&] (NODE_T t) {
+                    EXPECT_EQ(splitQuery.getDistance(s, t, -1), packedQuery.getDistance(s, t, -1));
+                    EXPECT_EQ(splitForwardStallingQuery.getDistance(s, t, -1), packedForwardStallingQuery.getDistance(s, t, -1));
+                });
+        });
+}
+
+TEST(EdgeHierarchyQueryStateTest, RelaxBatchingGivesSameDistances) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> query(queryGraph);
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> batchedQuery(queryGraph);
+    EdgeHierarchyQueryOnly<true, false, false, false, EdgeHierarchyGraphQueryOnly, SplitQueryState> forwardStallingQuery(queryGraph);
+    EdgeHierarchyQueryOnly<true, false, false, false, EdgeHierarchyGraphQueryOnly, SplitQueryState> batchedForwardStallingQuery(queryGraph);
+
+    for(unsigned batchSize : {1, 2, 16}) {
+        batchedQuery.setRelaxBatchSize(batchSize);
+        batchedForwardStallingQuery.setRelaxBatchSize(batchSize);
+        g.forAllNodes([&] (NODE_T s) {
+                g.forAllNodes([&] (NODE_T t) {
+                        EXPECT_EQ(query.getDistance(s, t, -1), batchedQuery.getDistance(s, t, -1));
+                        EXPECT_EQ(forwardStallingQuery.getDistance(s, t, -1), batchedForwardStallingQuery.getDistance(s, t, -1));
+                    });
+            });
+    }
+}
+
+// Backward stalling on the given layout has to check the same edges as on
+// the grouped one
+template<EdgeLayout layout>
+void expectSameStallsAsGrouped(EdgeHierarchyGraph &g) {
+    std::vector<NODE_T> order(g.getNumberOfNodes());
+    std::iota(order.begin(), order.end(), 0);
+    EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_GROUPED> expectedGraph(g.getNumberOfNodes());
+    expectedGraph.buildPermuted(g, order, 1);
+    EdgeHierarchyGraphQueryOnlyLayout<layout> resultGraph(g.getNumberOfNodes());
+    resultGraph.buildPermuted(g, order, 1);
+
+    EdgeHierarchyQueryOnly<false, true, true, false, EdgeHierarchyGraphQueryOnlyLayout<EDGE_LAYOUT_GROUPED>, PackedQueryState> expectedQuery(expectedGraph);
+    EdgeHierarchyQueryOnly<false, true, true, false, EdgeHierarchyGraphQueryOnlyLayout<layout>, PackedQueryState> resultQuery(resultGraph);
+    expectedQuery.setLogStalls(true);
+    resultQuery.setLogStalls(true);
+    auto toTuples = [] (const std::vector<loggedStall> &stalls) {
+        std::vector<std::tuple<NODE_T, NODE_T, EDGEWEIGHT_T, EDGECOUNT_T, EDGECOUNT_T>> result;
+        for(const loggedStall &stall : stalls) {
+            result.emplace_back(stall.v, stall.neighbor, stall.weight, stall.position, stall.numEdges);
+        }
+        return result;
+    };
+    for(int percent : {50, 100}) {
+        g.forAllNodes([&] (NODE_T s) {
+                g.forAllNodes([&] (NODE_T t) {
+                        EXPECT_EQ(resultQuery.getDistance(s, t, percent), expectedQuery.getDistance(s, t, percent));
+                        EXPECT_EQ(toTuples(resultQuery.stallLogForward), toTuples(expectedQuery.stallLogForward));
+                        EXPECT_EQ(toTuples(resultQuery.stallLogBackward), toTuples(expectedQuery.stallLogBackward));
+                    });
+            });
+    }
+    EXPECT_EQ(resultQuery.numEdgesLookedAtForStalling, expectedQuery.numEdgesLookedAtForStalling);
+}
+
+TEST(EdgeHierarchyQueryStateTest, LayoutsStallAlike) {
+    EdgeHierarchyGraph g = getRankedGraph();
+    expectSameStallsAsGrouped<EDGE_LAYOUT_COMPRESSED>(g);
+    expectSameStallsAsGrouped<EDGE_LAYOUT_PACKED>(g);
+    expectSameStallsAsGrouped<EDGE_LAYOUT_PACKED_16>(g);
+}
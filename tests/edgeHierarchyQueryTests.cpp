@@ -12,6 +12,11 @@
 
 #include "edgeHierarchyGraph.h"
 #include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+
+#include "testGraphs.h"
 
 TEST(EdgeHierarchyQueryTests, GetDistanceNoLevels) {
     //          ---3---
@@ -107,7 +112,7 @@ TEST(EdgeHierarchyQueryTests, ImpossibleLevels) {
     g.setEdgeRank(3, 4, 3);
 
     EDGEWEIGHT_T distance = query.getDistance(0, 4);
-    EXPECT_EQ(distance, EDGERANK_INFINIY);
+    EXPECT_EQ(distance, EDGEWEIGHT_INFINITY);
 }
 
 TEST(EdgeHierarchyQueryTests, PartialHierarchy) {
@@ -165,6 +170,37 @@ TEST(EdgeHierarchyQueryTests, MaximumDistanceExact) {
     EXPECT_EQ(query.getDistance(0, 1, 1), 1);
 }
 
+TEST(EdgeHierarchyQueryTests, ApproximateDistancesAreBounded) {
+    EdgeHierarchyGraph g = getGridGraph();
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> exactQuery(queryGraph);
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> approximateQuery(queryGraph);
+
+    for(double epsilon : {0.0, 0.1, 0.5, 2.0}) {
+        approximateQuery.setApproximationEpsilon(epsilon);
+        exactQuery.resetCounters();
+        approximateQuery.resetCounters();
+        for(NODE_T s = 0; s < 60; ++s) {
+            for(NODE_T t = 0; t < 60; ++t) {
+                const EDGEWEIGHT_T distance = originalGraphQuery.getDistance(s, t);
+                EXPECT_EQ(exactQuery.getDistance(s, t, -1), distance);
+                EXPECT_EQ(exactQuery.getDistanceLowerBound(), distance);
+                boundedDistance approximate = approximateQuery.getBoundedDistance(s, t, -1);
+                EXPECT_GE(approximate.distance, distance);
+                EXPECT_LE(approximate.distance, distance * (1 + epsilon));
+                EXPECT_LE(approximate.distance - approximate.errorBound, distance);
+            }
+        }
+        EXPECT_LE(approximateQuery.numVerticesSettled, exactQuery.numVerticesSettled);
+    }
+}
+
 //TEST(EdgeHierarchyQueryTests, DirectPathNotShortestPath) {
 //    EdgeHierarchyGraph g(5);
 //    g.addEdge(0, 4, 1);
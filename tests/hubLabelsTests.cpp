@@ -0,0 +1,124 @@
+/*******************************************************************************
+ * tests/hubLabelsTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "hubLabels.h"
+
+#include "testGraphs.h"
+
+TEST(HubLabelsTest, CommonHubs) {
+    std::default_random_engine gen(7);
+    for(unsigned round = 0; round < 200; ++round) {
+        std::vector<NODE_T> hubsA, hubsB;
+        std::vector<EDGEWEIGHT_T> distancesA, distancesB;
+        for(NODE_T hub = 0; hub < 100; ++hub) {
+            if(gen() % 3 == 0) {
+                hubsA.push_back(hub);
+                distancesA.push_back(gen() % 1000);
+            }
+            if(gen() % 3 == 0) {
+                hubsB.push_back(hub);
+                distancesB.push_back(gen() % 1000);
+            }
+        }
+        EDGEWEIGHT_T expected = EDGEWEIGHT_INFINITY;
+        for(size_t i = 0; i < hubsA.size(); ++i) {
+            for(size_t j = 0; j < hubsB.size(); ++j) {
+                if(hubsA[i] == hubsB[j]) {
+                    expected = std::min<EDGEWEIGHT_T>(expected, distancesA[i] + distancesB[j]);
+                }
+            }
+        }
+        EXPECT_EQ(getShortestDistanceOverCommonHubs(hubsA.data(), distancesA.data(), hubsA.size(), hubsB.data(), distancesB.data(), hubsB.size()), expected);
+    }
+}
+
+TEST(HubLabelsTest, DistancesAreCorrect) {
+    EdgeHierarchyGraph g = getGridGraph(true);
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+
+    size_t searchSpaceSize = 0;
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> onlyQuery(queryGraph);
+    for(NODE_T v = 0; v < 64; ++v) {
+        onlyQuery.forAllVerticesInSearchSpace<true>(v, [&] (NODE_T hub, EDGEWEIGHT_T distance) {
+                ++searchSpaceSize;
+            });
+    }
+
+    HubLabels labels;
+    labels.build(queryGraph, 4);
+    EXPECT_EQ(labels.getNumberOfNodes(), 64u);
+    EXPECT_LE(labels.getNumberOfEntries(true), searchSpaceSize);
+
+    std::string fileName = ::testing::TempDir() + "hubLabelsTest.hl";
+    labels.write(fileName);
+    HubLabels mappedLabels;
+    mappedLabels.readMapped(fileName);
+    EXPECT_EQ(mappedLabels.getBytes(), labels.getBytes());
+
+    for(NODE_T u = 0; u < 64; ++u){
+        for(NODE_T v = 0; v < 64; ++v){
+            EDGEWEIGHT_T distance = originalGraphQuery.getDistance(u, v);
+            EXPECT_EQ(labels.getDistance(u, v), distance) << u << " " << v;
+            EXPECT_EQ(mappedLabels.getDistance(u, v), distance) << u << " " << v;
+        }
+    }
+    std::remove(fileName.c_str());
+}
+
+// Builds the labels with several threads sharing one query graph of the
+// given layout
+template<EdgeLayout layout>
+void expectLayoutDistancesCorrect(EdgeHierarchyGraph &g, EdgeHierarchyQuery &originalGraphQuery) {
+    std::vector<NODE_T> order = g.getDFSOrder<true>();
+    EdgeHierarchyGraphQueryOnlyLayout<layout> queryGraph(g.getNumberOfNodes());
+    queryGraph.buildPermuted(g, order, 1);
+
+    HubLabels labels;
+    labels.build(queryGraph, 4);
+    for(NODE_T u = 0; u < g.getNumberOfNodes(); ++u){
+        for(NODE_T v = 0; v < g.getNumberOfNodes(); ++v){
+            EXPECT_EQ(labels.getDistance(u, v), originalGraphQuery.getDistance(u, v)) << edgeLayoutNames[layout] << " " << u << " " << v;
+        }
+    }
+}
+
+TEST(HubLabelsTest, DistancesAreCorrectForAllLayouts) {
+    EdgeHierarchyGraph g = getGridGraph(true);
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+    // For the packed layouts
+    g.quantizeRanks();
+
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_GROUPED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_SPLIT>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_RANK_SPLIT>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_INTERLEAVED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_COMPRESSED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_PACKED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_PACKED_16>(g, originalGraphQuery);
+}
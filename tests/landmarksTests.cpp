@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * tests/landmarksTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "landmarks.h"
+
+#include "testGraphs.h"
+
+TEST(LandmarksTest, SelectionFromName) {
+    EXPECT_EQ(getLandmarkSelectionFromName("random"), LANDMARKS_RANDOM);
+    EXPECT_EQ(getLandmarkSelectionFromName("farthest"), LANDMARKS_FARTHEST);
+    EXPECT_EQ(getLandmarkSelectionFromName("avoid"), LANDMARKS_AVOID);
+}
+
+TEST(LandmarksTest, LowerBoundsAndPrunedQueries) {
+    EdgeHierarchyGraph g = getGridGraph(true);
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+
+    for(unsigned selection = 0; selection < NUM_LANDMARK_SELECTIONS; ++selection) {
+        Landmarks landmarks(queryGraph, 4, LandmarkSelection(selection), 42);
+        std::vector<NODE_T> chosen = landmarks.getLandmarks();
+        ASSERT_EQ(chosen.size(), 4u);
+        std::sort(chosen.begin(), chosen.end());
+        EXPECT_EQ(std::unique(chosen.begin(), chosen.end()), chosen.end());
+        EXPECT_EQ(landmarks.getBytes(), 2 * 4 * 64 * sizeof(EDGEWEIGHT_T));
+
+        EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> landmarkQuery(queryGraph);
+        landmarkQuery.setLandmarks(&landmarks);
+
+        for(NODE_T u = 0; u < 64; ++u){
+            for(NODE_T v = 0; v < 64; ++v){
+                EDGEWEIGHT_T distance = originalGraphQuery.getDistance(u, v);
+                EDGEWEIGHT_T lowerBound = landmarks.getLowerBound(queryGraph.getInternalNodeNumber(u), queryGraph.getInternalNodeNumber(v));
+                EXPECT_LE(lowerBound, distance) << landmarkSelectionNames[selection] << " " << u << " " << v;
+                EXPECT_EQ(landmarkQuery.getDistance(u, v, -1), distance) << landmarkSelectionNames[selection] << " " << u << " " << v;
+            }
+        }
+        // 63 reaches no other vertex, which every landmark shows
+        EXPECT_EQ(landmarks.getLowerBound(queryGraph.getInternalNodeNumber(63), queryGraph.getInternalNodeNumber(0)), EDGEWEIGHT_INFINITY);
+    }
+}
+
+// Undirected graph given by adjacency lists, enough for the Dijkstra runs of
+// the landmark selection
+struct AdjacencyListGraph {
+    explicit AdjacencyListGraph(NODE_T n) : neighbors(n) {}
+
+    void addEdge(NODE_T u, NODE_T v, EDGEWEIGHT_T weight) {
+        neighbors[u].push_back({v, weight});
+        neighbors[v].push_back({u, weight});
+    }
+
+    NODE_T getNumberOfNodes() const {
+        return neighbors.size();
+    }
+
+    template<typename F>
+    void forAllNeighborsOutWithHighRank(NODE_T u, EDGERANK_T, F &&f) const {
+        for(const auto &[v, weight] : neighbors[u]) {
+            f(v, 0, weight);
+        }
+    }
+
+    template<typename F>
+    void forAllNeighborsInWithHighRank(NODE_T u, EDGERANK_T rank, F &&f) const {
+        forAllNeighborsOutWithHighRank(u, rank, f);
+    }
+
+    std::vector<std::vector<std::pair<NODE_T, EDGEWEIGHT_T>>> neighbors;
+};
+
+// Shortest path tree from 0: 0 -> 1 -> {2, 3 -> 4}, 0 -> 5, 0 -> 6 -> 7.
+// With landmark 5 only 4 weighs anything (d(0, 4) = 3, but 5 bounds it by
+// d(5, 4) - d(5, 0) = 2), so avoid descends to 4. Vertices 2 and 7 weigh
+// nothing without containing a landmark and must not hide their subtrees.
+TEST(LandmarksTest, AvoidFollowsHeaviestSubtree) {
+    AdjacencyListGraph g(8);
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 2, 1);
+    g.addEdge(1, 3, 1);
+    g.addEdge(3, 4, 1);
+    g.addEdge(0, 5, 1);
+    g.addEdge(5, 4, 3);
+    g.addEdge(0, 6, 1);
+    g.addEdge(6, 7, 1);
+
+    // Seed that draws 5 as the first landmark and 0 as the root of the tree,
+// skipping the draw the second landmark replaces
+    unsigned seed = 0;
+    for(; seed < 100000; ++seed) {
+        std::default_random_engine gen(seed);
+        std::uniform_int_distribution<NODE_T> randomVertex(0, 7);
+        const NODE_T first = randomVertex(gen);
+        randomVertex(gen);
+        if(first == 5 && randomVertex(gen) == 0) {
+            break;
+        }
+    }
+    ASSERT_LT(seed, 100000u);
+
+    Landmarks landmarks(g, 2, LANDMARKS_AVOID, seed);
+    ASSERT_EQ(landmarks.getLandmarks()[0], 5u);
+    EXPECT_EQ(landmarks.getLandmarks()[1], 4u);
+}
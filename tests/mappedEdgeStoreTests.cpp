@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * tests/mappedEdgeStoreTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "mappedEdgeStore.h"
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeRanking/shortcutCountingRoundsEdgeRanker.h"
+
+TEST(MappedEdgeStoreTest, ConstructionOnMappedStore) {
+    EdgeHierarchyGraph originalGraph(100);
+    for(NODE_T v = 0; v + 1 < 100; ++v) {
+        originalGraph.addEdge(v, v + 1, 1 + v % 3);
+        originalGraph.addEdge(v + 1, v, 1 + v % 5);
+        if(v + 10 < 100) {
+            originalGraph.addEdge(v, v + 10, 1 + v % 7);
+        }
+    }
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    MappedEdgeStore::get().open(::testing::TempDir() + "mappedEdgeStoreTest.bin", 0);
+
+    EdgeHierarchyGraph g(originalGraph);
+    EXPECT_GT(MappedEdgeStore::get().getMappedBytes(), 0);
+
+    EdgeHierarchyQuery query(g);
+    EdgeHierarchyConstruction<ShortcutCountingRoundsEdgeRanker> construction(g, query);
+    construction.run();
+
+    // All edges are ranked, so the adjacency lists of every vertex are cold
+    const size_t residentBytes = MappedEdgeStore::get().getResidentBytes();
+    MappedEdgeStore::get().evictColdPages();
+    EXPECT_GT(MappedEdgeStore::get().getEvictedBytes(), 0);
+    EXPECT_LT(MappedEdgeStore::get().getResidentBytes(), residentBytes);
+
+    for(NODE_T u = 0; u < 100; ++u){
+        for(NODE_T v = 0; v < 100; ++v){
+            EXPECT_EQ(query.getDistance(u, v), originalGraphQuery.getDistance(u,v));
+        }
+    }
+}
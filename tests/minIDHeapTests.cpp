@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * tests/minIDHeapTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "minIDHeap.h"
+
+TEST(MinIDHeapTest, SimpleTest) {
+    MinIDHeap<uint32_t, uint32_t> heap(10);
+    EXPECT_TRUE(heap.empty());
+
+    heap.push({3, 7});
+    heap.push({5, 2});
+    heap.push({8, 9});
+    EXPECT_EQ(heap.size(), 3);
+    EXPECT_TRUE(heap.contains(3));
+    EXPECT_FALSE(heap.contains(4));
+    EXPECT_EQ(heap.peek().id, 5);
+
+    heap.decreaseKey({8, 1});
+    EXPECT_EQ(heap.peek().id, 8);
+    EXPECT_EQ(heap.peek().key, 1);
+
+    auto popped = heap.pop();
+    EXPECT_EQ(popped.id, 8);
+    EXPECT_FALSE(heap.contains(8));
+    popped = heap.pop();
+    EXPECT_EQ(popped.id, 5);
+    EXPECT_EQ(popped.key, 2);
+
+    heap.clear();
+    EXPECT_TRUE(heap.empty());
+    EXPECT_FALSE(heap.contains(3));
+    heap.push({3, 4});
+    EXPECT_EQ(heap.pop().key, 4);
+}
+
+// Keys beyond 32 bits and 16 bit IDs
+TEST(MinIDHeapTest, WideKeys) {
+    MinIDHeap<uint16_t, uint64_t> heap(3);
+    heap.push({0, uint64_t(1) << 40});
+    heap.push({1, (uint64_t(1) << 40) - 1});
+    heap.push({2, uint64_t(1) << 33});
+    EXPECT_EQ(heap.pop().id, 2);
+    EXPECT_EQ(heap.pop().id, 1);
+    EXPECT_EQ(heap.pop().key, uint64_t(1) << 40);
+}
+
+// Random pushes, decreases and pops against a linear scan for the minimum
+TEST(MinIDHeapTest, MatchesLinearScan) {
+    const uint32_t n = 200;
+    MinIDHeap<uint32_t, uint32_t> heap(n);
+    std::vector<uint32_t> keys(n);
+    std::vector<bool> inHeap(n, false);
+    std::mt19937 gen(3);
+
+    for(unsigned step = 0; step < 20000; ++step) {
+        const uint32_t v = gen() % n;
+        const unsigned operation = gen() % 3;
+        if(operation == 0 && !inHeap[v]) {
+            keys[v] = gen() % 1000;
+            heap.push({v, keys[v]});
+            inHeap[v] = true;
+        }
+        else if(operation == 1 && inHeap[v] && keys[v] > 0) {
+            keys[v] -= gen() % keys[v] + 1;
+            heap.decreaseKey({v, keys[v]});
+        }
+        else if(operation == 2 && !heap.empty()) {
+            uint32_t minKey = UINT32_MAX;
+            for(uint32_t u = 0; u < n; ++u) {
+                if(inHeap[u]) {
+                    minKey = std::min(minKey, keys[u]);
+                }
+            }
+            auto popped = heap.pop();
+            ASSERT_EQ(popped.key, minKey);
+            ASSERT_TRUE(inHeap[popped.id]);
+            ASSERT_EQ(keys[popped.id], popped.key);
+            inHeap[popped.id] = false;
+        }
+        for(uint32_t u : {v, (v + 1) % n}) {
+            ASSERT_EQ(heap.contains(u), inHeap[u]);
+        }
+    }
+}
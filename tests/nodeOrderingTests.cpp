@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * tests/nodeOrderingTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "nodeOrdering.h"
+
+bool isPermutation(std::vector<NODE_T> order) {
+    std::sort(order.begin(), order.end());
+    for(NODE_T i = 0; i < order.size(); ++i) {
+        if(order[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+EdgeHierarchyGraph getOrderingTestGraph() {
+    //   1     2     3
+    // 0 --> 1 <-- 2 --> 3    4 --> 5
+    //                       4
+    EdgeHierarchyGraph g(6);
+    g.addEdge(0, 1, 1);
+    g.addEdge(2, 1, 2);
+    g.addEdge(2, 3, 3);
+    g.addEdge(4, 5, 4);
+    g.setEdgeRank(0, 1, 2);
+    g.setEdgeRank(2, 1, 4);
+    g.setEdgeRank(2, 3, 1);
+    g.setEdgeRank(4, 5, 3);
+    return g;
+}
+
+TEST(NodeOrderingTest, BFSOrder) {
+    EdgeHierarchyGraph g = getOrderingTestGraph();
+
+    EXPECT_EQ(getBFSOrder(g), std::vector<NODE_T>({0, 1, 2, 3, 4, 5}));
+
+    std::vector<NODE_T> partition = getBFSPartition(g, 3);
+    EXPECT_EQ(partition, std::vector<NODE_T>({0, 0, 1, 1, 2, 2}));
+}
+
+TEST(NodeOrderingTest, MaxEdgeRankOrder) {
+    EdgeHierarchyGraph g = getOrderingTestGraph();
+
+    // Maximum incident ranks are 2, 4, 4, 1, 3, 3
+    EXPECT_EQ(getMaxEdgeRankOrder(g), std::vector<NODE_T>({4, 0, 1, 5, 2, 3}));
+}
+
+TEST(NodeOrderingTest, HotCoreOrder) {
+    EdgeHierarchyGraph g = getOrderingTestGraph();
+    std::vector<NODE_T> baseOrder = {5, 4, 3, 2, 1, 0};
+
+    // Vertices 1 and 2 have the highest incident ranks
+    EXPECT_EQ(getHotCoreSize(g.getNumberOfNodes(), 30), 2);
+    EXPECT_EQ(getHotCoreOrder(g, baseOrder, 30), std::vector<NODE_T>({5, 1, 0, 4, 3, 2}));
+
+    EXPECT_EQ(getHotCoreOrder(g, baseOrder, 0), baseOrder);
+    EXPECT_EQ(getHotCoreOrder(g, baseOrder, 100), baseOrder);
+}
+
+TEST(NodeOrderingTest, HilbertOrder) {
+    // Corners of a square are visited in the order of the first Hilbert curve
+    std::vector<pair<int32_t, int32_t>> coordinates = {{-10, 10}, {10, 10}, {10, -10}, {-10, -10}};
+
+    EXPECT_EQ(getHilbertOrder(coordinates), std::vector<NODE_T>({1, 2, 3, 0}));
+}
+
+TEST(NodeOrderingTest, AllOrdersArePermutations) {
+    EdgeHierarchyGraph g = getOrderingTestGraph();
+    std::vector<NODE_T> chRank = {5, 4, 3, 2, 1, 0};
+    std::vector<pair<int32_t, int32_t>> coordinates = {{0, 0}, {1, 0}, {2, 0}, {3, 0}, {0, 5}, {1, 5}};
+
+    for(unsigned order = 0; order < NUM_NODE_ORDERS; ++order) {
+        EXPECT_TRUE(isNodeOrderAvailable(NodeOrder(order), chRank, coordinates));
+        std::vector<NODE_T> nodeOrder = getNodeOrder(NodeOrder(order), g, chRank, coordinates, 2, 50);
+        EXPECT_EQ(nodeOrder.size(), g.getNumberOfNodes());
+        EXPECT_TRUE(isPermutation(nodeOrder)) << nodeOrderNames[order];
+        EXPECT_EQ(getNodeOrderFromName(nodeOrderNames[order]), NodeOrder(order));
+    }
+
+    EXPECT_FALSE(isNodeOrderAvailable(NODE_ORDER_HILBERT, chRank, {}));
+    EXPECT_FALSE(isNodeOrderAvailable(NODE_ORDER_CH, {}, coordinates));
+}
@@ -0,0 +1,42 @@
+/*******************************************************************************
+ * tests/parallelForTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+#include <atomic>
+#include <numeric>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "parallelFor.h"
+
+TEST(ParallelForTest, VisitsEveryIndexOnce) {
+    std::vector<std::atomic<unsigned>> visits(10000);
+    parallelFor(0, visits.size(), 4, [&] (size_t i) {
+            ++visits[i];
+        }, 100);
+    for(const auto &count : visits) {
+        EXPECT_EQ(count, 1u);
+    }
+}
+
+TEST(ParallelForTest, PrefixSumMatchesSequential) {
+    for(size_t size : {0, 1, 7, 1000, 1001}) {
+        for(unsigned numThreads : {1, 3, 4, 16}) {
+            std::vector<uint64_t> values(size);
+            for(size_t i = 0; i < size; ++i) {
+                values[i] = (i * 7919) % 13;
+            }
+            std::vector<uint64_t> expected(size);
+            std::partial_sum(values.begin(), values.end(), expected.begin());
+
+            parallelPrefixSum(values, numThreads, 10);
+            EXPECT_EQ(values, expected) << size << " " << numThreads;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+ * tests/partitionedEdgeHierarchyConstructionTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "partitionedEdgeHierarchyConstruction.h"
+#include "edgeRanking/shortcutCountingRoundsEdgeRanker.h"
+
+#include "testGraphs.h"
+
+TEST(PartitionedEdgeHierarchyConstructionTest, BFSPartitionIsBalanced) {
+    EdgeHierarchyGraph g = getGridGraph(6, 6);
+
+    auto partition = getBFSPartition(g, 4);
+
+    std::vector<NODE_T> blockSize(4, 0);
+    for(NODE_T block : partition) {
+        ASSERT_LT(block, 4);
+        ++blockSize[block];
+    }
+    for(NODE_T size : blockSize) {
+        EXPECT_EQ(size, 9);
+    }
+}
+
+TEST(PartitionedEdgeHierarchyConstructionTest, DistancesAreCorrect) {
+    EdgeHierarchyGraph g = getGridGraph(8, 8);
+
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    auto partition = getBFSPartition(g, 4);
+    PartitionedEdgeHierarchyConstruction<ShortcutCountingRoundsEdgeRanker> construction(g, partition, 4, 2, ::testing::TempDir() + "partitionedConstructionTest");
+    construction.run();
+
+    g.forAllNodes( [&] (NODE_T u) {
+            g.forAllNeighborsOut(u, [&] (NODE_T v, EDGEWEIGHT_T weight) {
+                    EXPECT_LT(g.getEdgeRank(u, v), EDGERANK_INFINIY);
+                });
+        });
+
+    EdgeHierarchyQuery query(g);
+    for(NODE_T u = 0; u < g.getNumberOfNodes(); ++u){
+        for(NODE_T v = 0; v < g.getNumberOfNodes(); ++v){
+            EXPECT_EQ(query.getDistance(u, v), originalGraphQuery.getDistance(u,v));
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * tests/stallCandidatesTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "stallCandidates.h"
+
+#include "testGraphs.h"
+
+TEST(StallCandidatesTest, BuildByWeightKeepsLightestEdges) {
+    EdgeHierarchyGraph g(4);
+    g.addEdge(1, 0, 5);
+    g.addEdge(2, 0, 1);
+    g.addEdge(3, 0, 3);
+    g.addEdge(0, 3, 2);
+    g.sortEdges();
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getReorderedGraph<EdgeHierarchyGraphQueryOnly>({0, 1, 2, 3});
+    queryGraph.makeConsecutive();
+
+    StallCandidates candidates(4);
+    candidates.buildByWeight(queryGraph, 2);
+
+    neighborWeightRange in = candidates.getCandidatesIn(0);
+    ASSERT_EQ(in.size, 2u);
+    EXPECT_EQ(in.getNeighbor(0), 2u);
+    EXPECT_EQ(in.getWeight(0), 1u);
+    EXPECT_EQ(in.getNeighbor(1), 3u);
+    EXPECT_EQ(in.getWeight(1), 3u);
+
+    EXPECT_EQ(candidates.getCandidatesOut(0).size, 1u);
+    EXPECT_EQ(candidates.getCandidatesOut(1).size, 1u);
+    EXPECT_EQ(candidates.getCandidatesIn(1).size, 0u);
+    EXPECT_EQ(candidates.getNumberOfCandidates(), 7u);
+}
+
+TEST(StallCandidatesTest, DistancesAreCorrect) {
+    EdgeHierarchyGraph g = getGridGraph();
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> fullStallingQuery(queryGraph);
+    std::vector<pair<NODE_T, NODE_T>> sampleQueries = getSampleQueries(60);
+    StallCandidates sampleCandidates(60);
+    sampleCandidates.buildFromSampleQueries(fullStallingQuery, sampleQueries, 2);
+    EXPECT_GT(sampleCandidates.getNumberOfCandidates(), 0u);
+
+    StallCandidates weightCandidates(60);
+    weightCandidates.buildByWeight(queryGraph, 2);
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> sampleQuery(queryGraph);
+    sampleQuery.setStallCandidates(&sampleCandidates);
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, SplitQueryState> weightQuery(queryGraph);
+    weightQuery.setStallCandidates(&weightCandidates);
+
+    for(NODE_T u = 0; u < 60; ++u){
+        for(NODE_T v = 0; v < 60; ++v){
+            EDGEWEIGHT_T distance = originalGraphQuery.getDistance(u, v);
+            EXPECT_EQ(sampleQuery.getDistance(u, v, -1), distance);
+            EXPECT_EQ(weightQuery.getDistance(u, v, -1), distance);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * tests/stallingCalibrationTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "stallingCalibration.h"
+
+#include "testGraphs.h"
+
+TEST(StallingCalibrationTest, ChoosesBudgetWithLargestGain) {
+    std::vector<loggedStall> checks;
+    // Vertex 0: usually stalled by its first edge
+    for(unsigned i = 0; i < 8; ++i) {
+        checks.push_back({0, 5, 1, 0, 10});
+    }
+    checks.push_back({0, 6, 1, 7, 10});
+    checks.push_back({0, NODE_INVALID, 0, 10, 10});
+    // Vertex 1: never stalled
+    for(unsigned i = 0; i < 4; ++i) {
+        checks.push_back({1, NODE_INVALID, 0, 3, 3});
+    }
+    // Vertex 2: stalled by its last edge, but stalling saves a lot
+    for(unsigned i = 0; i < 4; ++i) {
+        checks.push_back({2, 7, 1, 3, 4});
+    }
+
+    std::vector<uint8_t> percents = getStallingPercents(4, checks, {5, 5, 100, 5});
+    EXPECT_EQ(percents[0], 10);
+    EXPECT_EQ(percents[1], 0);
+    EXPECT_EQ(percents[2], 100);
+    EXPECT_EQ(percents[3], 100);
+}
+
+TEST(StallingCalibrationTest, DistancesAreCorrect) {
+    EdgeHierarchyGraph g = getGridGraph();
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> calibrationQuery(queryGraph);
+    std::vector<pair<NODE_T, NODE_T>> sampleQueries = getSampleQueries(60);
+    calibrateStallingBudgets(queryGraph, calibrationQuery, sampleQueries);
+
+    EdgeHierarchyQueryOnly<false, true, true, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> budgetQuery(queryGraph);
+    budgetQuery.setUseStallingBudgets(true);
+    for(NODE_T u = 0; u < 60; ++u){
+        for(NODE_T v = 0; v < 60; ++v){
+            EXPECT_EQ(budgetQuery.getDistance(u, v, 0), originalGraphQuery.getDistance(u, v));
+        }
+    }
+}
+
+// Budgets only apply to partial stalling: full backward stalling checks the
+// same edges with and without them
+TEST(StallingCalibrationTest, FullStallingIgnoresBudgets) {
+    EdgeHierarchyGraph g = getGridGraph();
+    buildEdgeHierarchy(g);
+
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+    std::vector<uint8_t> noStalling(queryGraph.getNumberOfNodes(), 0);
+    queryGraph.setStallingPercents(noStalling, noStalling);
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> fullQuery(queryGraph);
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> budgetQuery(queryGraph);
+    budgetQuery.setUseStallingBudgets(true);
+    for(NODE_T u = 0; u < 60; ++u){
+        for(NODE_T v = 0; v < 60; ++v){
+            EXPECT_EQ(budgetQuery.getDistance(u, v, -1), fullQuery.getDistance(u, v, -1));
+        }
+    }
+    EXPECT_GT(fullQuery.numEdgesLookedAtForStalling, 0u);
+    EXPECT_EQ(budgetQuery.numEdgesLookedAtForStalling, fullQuery.numEdgesLookedAtForStalling);
+}
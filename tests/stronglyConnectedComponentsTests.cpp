@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * tests/stronglyConnectedComponentsTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "stronglyConnectedComponents.h"
+#include "edgeRanking/shortcutCountingRoundsEdgeRanker.h"
+
+// Cycle 0 -> 1 -> 2 -> 0, cycle 3 <-> 4 reachable from it, cycle
+// 5 -> 6 -> 7 -> 8 -> 5 and the isolated vertex 9
+EdgeHierarchyGraph getComponentsGraph() {
+    EdgeHierarchyGraph g(10);
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 2, 2);
+    g.addEdge(2, 0, 3);
+    g.addEdge(2, 3, 1);
+    g.addEdge(3, 4, 4);
+    g.addEdge(4, 3, 1);
+    g.addEdge(5, 6, 1);
+    g.addEdge(6, 7, 1);
+    g.addEdge(7, 8, 2);
+    g.addEdge(8, 5, 1);
+    g.addEdge(6, 4, 1);
+    return g;
+}
+
+TEST(StronglyConnectedComponentsTest, Labels) {
+    EdgeHierarchyGraph g = getComponentsGraph();
+    std::vector<NODE_T> component = getStronglyConnectedComponents(g);
+
+    ASSERT_EQ(component.size(), 10u);
+    EXPECT_EQ(component[0], component[1]);
+    EXPECT_EQ(component[0], component[2]);
+    EXPECT_EQ(component[3], component[4]);
+    EXPECT_EQ(component[5], component[6]);
+    EXPECT_EQ(component[5], component[7]);
+    EXPECT_EQ(component[5], component[8]);
+    EXPECT_NE(component[0], component[3]);
+    EXPECT_NE(component[0], component[5]);
+    EXPECT_NE(component[3], component[5]);
+    EXPECT_NE(component[9], component[0]);
+    EXPECT_NE(component[9], component[3]);
+    EXPECT_NE(component[9], component[5]);
+    EXPECT_EQ(*std::max_element(component.begin(), component.end()), 3u);
+    // Reverse topological order
+    EXPECT_GT(component[0], component[3]);
+    EXPECT_GT(component[5], component[3]);
+}
+
+TEST(StronglyConnectedComponentsTest, LargestComponentGraph) {
+    EdgeHierarchyGraph g = getComponentsGraph();
+    EdgeHierarchyGraph largest = getLargestComponentGraph(g);
+
+    EXPECT_EQ(largest.getNumberOfNodes(), 4u);
+    EXPECT_EQ(largest.getNumberOfEdges(), 4u);
+    EXPECT_TRUE(largest.hasEdge(0, 1));
+    EXPECT_TRUE(largest.hasEdge(1, 2));
+    EXPECT_EQ(largest.getEdgeWeight(2, 3), 2u);
+    EXPECT_TRUE(largest.hasEdge(3, 0));
+}
+
+TEST(StronglyConnectedComponentsTest, QueriesBetweenComponents) {
+    EdgeHierarchyGraph g = getComponentsGraph();
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    EdgeHierarchyQuery query(g);
+    EdgeHierarchyConstruction<ShortcutCountingRoundsEdgeRanker> construction(g, query);
+    construction.run();
+    g.sortEdges();
+
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+    EXPECT_EQ(queryGraph.computeComponents(), 4u);
+    auto mayReach = [&] (NODE_T u, NODE_T v) {
+        return queryGraph.mayReach(queryGraph.getInternalNodeNumber(u), queryGraph.getInternalNodeNumber(v));
+    };
+    EXPECT_TRUE(mayReach(5, 8));
+    EXPECT_TRUE(mayReach(5, 4));
+    EXPECT_FALSE(mayReach(4, 5));
+    EXPECT_FALSE(mayReach(3, 0));
+
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> onlyQuery(queryGraph);
+    for(NODE_T u = 0; u < 10; ++u){
+        for(NODE_T v = 0; v < 10; ++v){
+            EXPECT_EQ(onlyQuery.getDistance(u, v, -1), originalGraphQuery.getDistance(u, v)) << u << " " << v;
+        }
+    }
+}
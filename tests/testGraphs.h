@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * tests/testGraphs.h
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeRanking/shortcutCountingRoundsEdgeRanker.h"
+
+// Grid like graph on 0..59 with irregular weights. With withOneWayPath, the
+// one way path 59 -> 60 -> ... -> 63 is added, so that 63 reaches no other
+// vertex.
+inline EdgeHierarchyGraph getGridGraph(bool withOneWayPath = false) {
+    EdgeHierarchyGraph g(withOneWayPath ? 64 : 60);
+    for(NODE_T v = 0; v + 1 < 60; ++v) {
+        g.addEdge(v, v + 1, 1 + v % 4);
+        g.addEdge(v + 1, v, 1 + v % 3);
+        if(v + 6 < 60) {
+            g.addEdge(v, v + 6, 1 + (v * 7) % 9);
+            g.addEdge(v + 6, v, 1 + (v * 5) % 11);
+        }
+    }
+    if(withOneWayPath) {
+        for(NODE_T v = 59; v < 63; ++v) {
+            g.addEdge(v, v + 1, 2);
+        }
+    }
+    return g;
+}
+
+// width x height grid with irregular weights in both directions
+inline EdgeHierarchyGraph getGridGraph(NODE_T width, NODE_T height) {
+    EdgeHierarchyGraph g(width * height);
+    for(NODE_T y = 0; y < height; ++y) {
+        for(NODE_T x = 0; x < width; ++x) {
+            NODE_T v = y * width + x;
+            if(x + 1 < width) {
+                g.addEdge(v, v + 1, 1 + (x * 7 + y * 3) % 5);
+                g.addEdge(v + 1, v, 1 + (x * 5 + y * 11) % 7);
+            }
+            if(y + 1 < height) {
+                g.addEdge(v, v + width, 1 + (x * 3 + y * 13) % 4);
+                g.addEdge(v + width, v, 1 + (x * 11 + y * 7) % 6);
+            }
+        }
+    }
+    return g;
+}
+
+// Grid like graph on 0..39 where every edge has a reverse edge of the same
+// weight
+inline EdgeHierarchyGraph getSymmetricGridGraph() {
+    EdgeHierarchyGraph g(40);
+    for(NODE_T v = 0; v + 1 < 40; ++v) {
+        g.addEdge(v, v + 1, 1 + v % 4);
+        g.addEdge(v + 1, v, 1 + v % 4);
+        if(v + 5 < 40) {
+            g.addEdge(v, v + 5, 1 + (v * 7) % 9);
+            g.addEdge(v + 5, v, 1 + (v * 7) % 9);
+        }
+    }
+    return g;
+}
+
+// Queries from every 7th to every 5th vertex below n, as used to calibrate
+// backward stalling
+inline std::vector<std::pair<NODE_T, NODE_T>> getSampleQueries(NODE_T n) {
+    std::vector<std::pair<NODE_T, NODE_T>> sampleQueries;
+    for(NODE_T u = 0; u < n; u += 7) {
+        for(NODE_T v = 0; v < n; v += 5) {
+            sampleQueries.emplace_back(u, v);
+        }
+    }
+    return sampleQueries;
+}
+
+// Ranks the edges of g with the shortcut counting rounds edge ranker and
+// sorts them by rank
+inline void buildEdgeHierarchy(EdgeHierarchyGraph &g) {
+    EdgeHierarchyQuery query(g);
+    EdgeHierarchyConstruction<ShortcutCountingRoundsEdgeRanker> construction(g, query);
+    construction.run();
+    g.sortEdges();
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * tests/transitNodesTests.cpp
+ *
+ * Copyright (C) 2019 Demian Hespe <hespe@kit.edu>
+ *
+ * All rights reserved.
+ ******************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "edgeHierarchyGraph.h"
+#include "edgeHierarchyQuery.h"
+#include "edgeHierarchyConstruction.h"
+#include "edgeHierarchyGraphQueryOnly.h"
+#include "edgeHierarchyQueryOnly.h"
+#include "transitNodes.h"
+
+#include "testGraphs.h"
+
+void expectTransitNodeDistancesCorrect(bool quantizeRanks) {
+    EdgeHierarchyGraph g = getGridGraph(true);
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+    if(quantizeRanks) {
+        g.quantizeRanks();
+    }
+
+    EdgeHierarchyGraphQueryOnly queryGraph = g.getDFSOrderGraph<EdgeHierarchyGraphQueryOnly, true>();
+    queryGraph.makeConsecutive();
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnly, PackedQueryState> onlyQuery(queryGraph);
+
+    for(NODE_T minTransitNodes : {1, 6, 20, 64}) {
+        // One cell per vertex, a few vertices per cell and a single cell
+        size_t previousNumGlobal = 64 * 64;
+        for(size_t numCells : {64, 16, 1}) {
+            TransitNodes transitNodes;
+            transitNodes.build(queryGraph, minTransitNodes, 4, numCells);
+            EXPECT_GE(transitNodes.getNumberOfTransitNodes(), std::min<NODE_T>(minTransitNodes, 64));
+            EXPECT_EQ(transitNodes.getTableBytes(), size_t(transitNodes.getNumberOfTransitNodes()) * transitNodes.getNumberOfTransitNodes() * sizeof(EDGEWEIGHT_T));
+            EXPECT_EQ(transitNodes.getNumberOfCells(), numCells);
+            EXPECT_EQ(transitNodes.getLocalityFilterBytes(), 2 * 64 * sizeof(uint64_t));
+
+            size_t numGlobal = 0;
+            for(NODE_T u = 0; u < 64; ++u){
+                for(NODE_T v = 0; v < 64; ++v){
+                    EDGEWEIGHT_T distance = originalGraphQuery.getDistance(u, v);
+                    if(!transitNodes.isLocal(u, v)) {
+                        ++numGlobal;
+                        EXPECT_EQ(transitNodes.getGlobalDistance(u, v), distance) << minTransitNodes << " " << u << " " << v;
+                    }
+                    EXPECT_EQ(transitNodes.getDistance(onlyQuery, u, v, -1), distance) << minTransitNodes << " " << u << " " << v;
+                }
+            }
+            if(minTransitNodes == 6 && numCells == 64) {
+                EXPECT_GT(numGlobal, 0u);
+            }
+            // Coarser cells only make more queries local
+            EXPECT_LE(numGlobal, previousNumGlobal);
+            previousNumGlobal = numGlobal;
+        }
+    }
+}
+
+TEST(TransitNodesTest, DistancesAreCorrect) {
+    expectTransitNodeDistancesCorrect(false);
+}
+
+TEST(TransitNodesTest, DistancesAreCorrectWithQuantizedRanks) {
+    expectTransitNodeDistancesCorrect(true);
+}
+
+// Builds the transit nodes with several threads sharing one query graph of
+// the given layout
+template<EdgeLayout layout>
+void expectLayoutDistancesCorrect(EdgeHierarchyGraph &g, EdgeHierarchyQuery &originalGraphQuery) {
+    std::vector<NODE_T> order = g.getDFSOrder<true>();
+    EdgeHierarchyGraphQueryOnlyLayout<layout> queryGraph(g.getNumberOfNodes());
+    queryGraph.buildPermuted(g, order, 1);
+    EdgeHierarchyQueryOnly<false, true, false, false, EdgeHierarchyGraphQueryOnlyLayout<layout>, PackedQueryState> onlyQuery(queryGraph);
+
+    TransitNodes transitNodes;
+    transitNodes.build(queryGraph, 6, 4);
+    for(NODE_T u = 0; u < g.getNumberOfNodes(); ++u){
+        for(NODE_T v = 0; v < g.getNumberOfNodes(); ++v){
+            EXPECT_EQ(transitNodes.getDistance(onlyQuery, u, v, -1), originalGraphQuery.getDistance(u, v)) << edgeLayoutNames[layout] << " " << u << " " << v;
+        }
+    }
+}
+
+TEST(TransitNodesTest, DistancesAreCorrectForAllLayouts) {
+    EdgeHierarchyGraph g = getGridGraph(true);
+    EdgeHierarchyGraph originalGraph(g);
+    EdgeHierarchyQuery originalGraphQuery(originalGraph);
+
+    buildEdgeHierarchy(g);
+    // For the packed layouts
+    g.quantizeRanks();
+
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_GROUPED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_SPLIT>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_RANK_SPLIT>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_INTERLEAVED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_COMPRESSED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_PACKED>(g, originalGraphQuery);
+    expectLayoutDistancesCorrect<EDGE_LAYOUT_PACKED_16>(g, originalGraphQuery);
+}